@@ -145,7 +145,7 @@ void AdsrCore::write_adsr_reg() {
    if (step == 0)
       step = 1;
    io_write(base_addr, ATK_REG, (uint32_t )step);
-   debug("adsr set - sus_level/atk_step: ", sus_abs, step);
+   log_dbg(LOG_MOD_ADSR, "adsr set - sus_level/atk_step: ", sus_abs, step);
    // convert decay time (in ms) into envelope decrement step
    nc = dms * clks;
    step = (MAX - sus_abs) / nc;
@@ -155,7 +155,7 @@ void AdsrCore::write_adsr_reg() {
    // convert sustain time (in ms) into #clocks
    nc = sms * clks;
    io_write(base_addr, SUS_REG, (uint32_t )nc);
-   debug("adsr set - sus_time/dcy_step: ", nc, step);
+   log_dbg(LOG_MOD_ADSR, "adsr set - sus_time/dcy_step: ", nc, step);
    // convert release time (in ms) into envelope decrement step
    nc = rms * clks;
    step = sus_abs / nc;
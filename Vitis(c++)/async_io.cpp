@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * @file async_io.cpp
+ *
+ * @brief implementation of AsyncTask frame pool and AsyncExecutor
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "async_io.h"
+
+#ifdef __cpp_impl_coroutine
+
+/**********************************************************************
+ * static coroutine frame pool
+ **********************************************************************/
+static union {
+   unsigned char bytes[AsyncExecutor::NUM_FRAMES][AsyncExecutor::FRAME_SIZE];
+   long double align;   // max alignment for frame contents
+} frame_pool;
+static uint32_t frame_used = 0;   // bit i set: frame i allocated
+
+void *AsyncTask::promise_type::operator new(size_t size) noexcept {
+   int i;
+
+   if (size > AsyncExecutor::FRAME_SIZE)
+      return (0);
+   for (i = 0; i < AsyncExecutor::NUM_FRAMES; i++) {
+      if (!(frame_used & (1UL << i))) {
+         frame_used = frame_used | (1UL << i);
+         return (frame_pool.bytes[i]);
+      }
+   }
+   return (0);   // task creation fails; see AsyncTask::valid()
+}
+
+void AsyncTask::promise_type::operator delete(void *p) noexcept {
+   int i;
+
+   i = (int) (((unsigned char *) p - frame_pool.bytes[0])
+         / AsyncExecutor::FRAME_SIZE);
+   frame_used = frame_used & ~(1UL << i);
+}
+
+/**********************************************************************
+ * AsyncTask
+ **********************************************************************/
+AsyncTask::AsyncTask() {
+   handle = 0;
+}
+
+AsyncTask::AsyncTask(std::coroutine_handle<promise_type> h) {
+   handle = h;
+}
+
+int AsyncTask::valid() {
+   return (handle ? 1 : 0);
+}
+
+/**********************************************************************
+ * AsyncOp
+ **********************************************************************/
+void AsyncOp::await_suspend(std::coroutine_handle<> h) {
+   AsyncExecutor::park(this, h);
+}
+
+/**********************************************************************
+ * AsyncExecutor
+ **********************************************************************/
+AsyncExecutor::Slot *AsyncExecutor::running = 0;
+
+AsyncExecutor::AsyncExecutor() {
+   int i;
+
+   for (i = 0; i < MAX_TASKS; i++) {
+      slot[i].h = 0;
+      slot[i].op = 0;
+   }
+   num = 0;
+}
+
+AsyncExecutor::~AsyncExecutor() {
+}
+
+int AsyncExecutor::spawn(AsyncTask task) {
+   int i;
+
+   if (!task.valid())
+      return (-1);
+   for (i = 0; i < MAX_TASKS; i++) {
+      if (!slot[i].h) {
+         slot[i].h = task.handle;
+         slot[i].op = 0;
+         num++;
+         return (0);
+      }
+   }
+   task.handle.destroy();
+   return (-1);
+}
+
+// the handle is that of the running slot; only the op is recorded
+void AsyncExecutor::park(AsyncOp *op, std::coroutine_handle<>) {
+   if (running)
+      running->op = op;
+}
+
+int AsyncExecutor::run_once() {
+   int i;
+
+   for (i = 0; i < MAX_TASKS; i++) {
+      if (!slot[i].h)
+         continue;
+      if (slot[i].op) {
+         if (!slot[i].op->poll())
+            continue;          // still waiting
+         slot[i].op = 0;
+      }
+      // resume until the task parks on another op or finishes
+      running = &slot[i];
+      slot[i].h.resume();
+      running = 0;
+      if (slot[i].h.done()) {
+         slot[i].h.destroy();
+         slot[i].h = 0;
+         num--;
+      }
+   }
+   return (num);
+}
+
+void AsyncExecutor::run() {
+   while (run_once()) {
+   }
+}
+
+int AsyncExecutor::active() {
+   return (num);
+}
+
+#endif  // __cpp_impl_coroutine
@@ -0,0 +1,155 @@
+/*****************************************************************//**
+ * @file async_io.h
+ *
+ * @brief C++20 coroutine support for non-blocking driver operations
+ *
+ * Description:
+ *  - available only when the compiler supports coroutines
+ *    (e.g., -std=c++20; gcc 10 also needs -fcoroutines);
+ *    otherwise this file is empty and the drivers are unchanged
+ *  - AsyncOp: a driver operation with a non-blocking poll(); it can be
+ *    co_await-ed inside an AsyncTask (e.g., co_await spi.transfer_async(b))
+ *  - a task suspends when its op is not ready and the executor resumes
+ *    it once poll() reports completion
+ *  - AsyncTask frames come from a static pool (no heap; the linker
+ *    script only provides a 0x800 heap)
+ *  - an AsyncTask cannot co_await another AsyncTask
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _ASYNC_IO_H_INCLUDED
+#define _ASYNC_IO_H_INCLUDED
+
+#ifdef __cpp_impl_coroutine
+
+#include <stddef.h>
+#include <coroutine>
+#include "chu_io_rw.h"
+
+/**
+ * awaitable non-blocking operation
+ *  - derived class implements poll() as a small state machine and
+ *    await_resume() to return the result
+ */
+class AsyncOp {
+public:
+   /**
+    * advance the operation without waiting
+    *
+    * @return 1: complete; 0: still in progress
+    */
+   virtual int poll() = 0;
+
+   /* awaiter interface */
+   bool await_ready() {
+      return (poll() != 0);
+   }
+   void await_suspend(std::coroutine_handle<> h);
+};
+
+/**
+ * coroutine return type of a task run by AsyncExecutor
+ */
+class AsyncTask {
+public:
+   struct promise_type {
+      AsyncTask get_return_object() {
+         return (AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)));
+      }
+      static AsyncTask get_return_object_on_allocation_failure() {
+         return (AsyncTask());
+      }
+      std::suspend_always initial_suspend() noexcept {
+         return {};
+      }
+      std::suspend_always final_suspend() noexcept {
+         return {};
+      }
+      void return_void() {
+      }
+      void unhandled_exception() {
+      }
+      /* frames come from the static pool */
+      static void *operator new(size_t size) noexcept;
+      static void operator delete(void *p) noexcept;
+   };
+
+   AsyncTask();
+   AsyncTask(std::coroutine_handle<promise_type> h);
+
+   /**
+    * check whether a frame was allocated
+    *
+    * @return 1: valid task; 0: frame pool exhausted
+    */
+   int valid();
+
+   std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * executor of async tasks
+ *  - fixed table of tasks; each task is either runnable or
+ *    parked on one AsyncOp
+ *  - run_once() polls parked ops and resumes completed tasks
+ */
+class AsyncExecutor {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      MAX_TASKS = 8,                   /**< # concurrent tasks */
+      FRAME_SIZE = 64 * sizeof(void *),/**< bytes per coroutine frame */
+      NUM_FRAMES = MAX_TASKS           /**< frame pool size */
+   };
+
+   AsyncExecutor();
+   ~AsyncExecutor();  // not used
+
+   /**
+    * add a task; it starts at the next run_once()
+    *
+    * @param task coroutine returned by an AsyncTask function
+    * @return 0: ok; -1: task table full or frame pool exhausted
+    */
+   int spawn(AsyncTask task);
+
+   /**
+    * poll parked operations once and resume tasks that can proceed
+    *
+    * @return # tasks not yet finished
+    */
+   int run_once();
+
+   /**
+    * run until all tasks finish
+    *
+    */
+   void run();
+
+   /**
+    * # tasks not yet finished
+    */
+   int active();
+
+   /**
+    * park the running task on an op (called by AsyncOp::await_suspend)
+    */
+   static void park(AsyncOp *op, std::coroutine_handle<> h);
+
+private:
+   struct Slot {
+      std::coroutine_handle<> h;   // null if slot is free
+      AsyncOp *op;                 // op to poll; null if runnable
+   };
+   Slot slot[MAX_TASKS];
+   int num;
+   static Slot *running;           // slot being resumed
+};
+
+#endif  // __cpp_impl_coroutine
+
+#endif  // _ASYNC_IO_H_INCLUDED
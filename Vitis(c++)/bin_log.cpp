@@ -0,0 +1,136 @@
+/*****************************************************************//**
+ * @file bin_log.cpp
+ *
+ * @brief implementation of BinLog class
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "bin_log.h"
+
+BinLog bin_log;
+
+BinLog::BinLog() {
+   head = 0;
+   tail = 0;
+   last_us = 0;
+   drop_cnt = 0;
+   byte_cnt = 0;
+}
+
+BinLog::~BinLog() {
+}
+
+// 7 bits per byte, lsb group first; bit 7 set on all but the last byte
+int BinLog::varint(uint8_t *p, uint32_t v) {
+   int n = 0;
+
+   while (v >= 0x80) {
+      p[n] = (uint8_t) (v | 0x80);
+      v = v >> 7;
+      n++;
+   }
+   p[n] = (uint8_t) v;
+   return (n + 1);
+}
+
+// zigzag: small negative values stay short
+int BinLog::enc(uint8_t *p, int v) {
+   return (varint(p, ((uint32_t) v << 1) ^ (uint32_t) (v >> 31)));
+}
+
+int BinLog::enc(uint8_t *p, unsigned int v) {
+   return (enc(p, (int) v));
+}
+
+int BinLog::enc(uint8_t *p, long v) {
+   return (enc(p, (int) v));
+}
+
+int BinLog::enc(uint8_t *p, unsigned long v) {
+   return (enc(p, (int) v));
+}
+
+// raw single-precision bits; no formatting on the target
+int BinLog::enc(uint8_t *p, double v) {
+   union {
+      float f;
+      uint32_t u;
+   } bits;
+
+   bits.f = (float) v;
+   p[0] = (uint8_t) bits.u;
+   p[1] = (uint8_t) (bits.u >> 8);
+   p[2] = (uint8_t) (bits.u >> 16);
+   p[3] = (uint8_t) (bits.u >> 24);
+   return (4);
+}
+
+int BinLog::begin(uint8_t *rec, uint16_t id) {
+   uint32_t now;
+   int n;
+
+   now = (uint32_t) now_us();
+   rec[0] = SYNC;
+   rec[1] = (uint8_t) id;
+   rec[2] = (uint8_t) (id >> 8);
+   n = 3 + varint(rec + 3, now - last_us);
+   last_us = now;
+   return (n);
+}
+
+// SYNC and ESC bytes after the start byte are sent as ESC, byte - ESC
+void BinLog::commit(const uint8_t *rec, int n) {
+   int i, len;
+
+   len = n;
+   for (i = 1; i < n; i++)
+      len += (rec[i] >= ESC);
+   if (BUF_SIZE - (int) (head - tail) < len) {
+      drop_cnt++;
+      return;
+   }
+   buf[head & (BUF_SIZE - 1)] = rec[0];
+   head++;
+   for (i = 1; i < n; i++) {
+      if (rec[i] >= ESC) {
+         buf[head & (BUF_SIZE - 1)] = ESC;
+         head++;
+         buf[head & (BUF_SIZE - 1)] = rec[i] - ESC;
+      } else {
+         buf[head & (BUF_SIZE - 1)] = rec[i];
+      }
+      head++;
+   }
+   byte_cnt = byte_cnt + len;
+}
+
+int BinLog::flush() {
+   int n, total, idx;
+
+   total = 0;
+   while (tail != head) {
+      // contiguous part up to the end of the array
+      idx = (int) (tail & (BUF_SIZE - 1));
+      n = (int) (head - tail);
+      if (n > BUF_SIZE - idx)
+         n = BUF_SIZE - idx;
+      uart.write(&buf[idx], n);
+      tail = tail + n;
+      total = total + n;
+   }
+   return (total);
+}
+
+int BinLog::pending() {
+   return ((int) (head - tail));
+}
+
+uint32_t BinLog::dropped() {
+   return (drop_cnt);
+}
+
+uint32_t BinLog::bytes() {
+   return (byte_cnt);
+}
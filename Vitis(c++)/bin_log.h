@@ -0,0 +1,142 @@
+/*****************************************************************//**
+ * @file bin_log.h
+ *
+ * @brief Deferred binary logging; text is rebuilt on the host
+ *
+ * Description:
+ *  - BLOG("fmt", args...) stores a record in a RAM ring:
+ *    message id, time stamp and raw argument values;
+ *    the format string itself is not linked into the program
+ *  - flush() sends the pending records via "uart"
+ *  - host tool tools/log_decode.cpp scans the sources for BLOG
+ *    format strings, builds the id table and prints the text;
+ *    normal uart text passes through the decoder unchanged
+ *  - format: printf-like %d %i %u %x %c %f with optional flags,
+ *    width and precision (e.g., %04x, %.3f); one argument per field
+ *  - format must be a single string literal
+ *
+ * Record (little endian):
+ *  - 0xff: start of record (never sent by uart text)
+ *  - 2-byte message id
+ *  - varint: microseconds since the previous record
+ *  - per argument: zigzag varint of the 32-bit integer value, or
+ *    4-byte IEEE single for floating-point arguments
+ *  - after the start byte, 0xfe and 0xff are sent as 0xfe 0x00 and
+ *    0xfe 0x01, so 0xff always marks a record start and the decoder
+ *    can resync after a lost byte
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _BIN_LOG_H_INCLUDED
+#define _BIN_LOG_H_INCLUDED
+
+#include "chu_init.h"
+#include "bin_log_id.h"
+
+/* forces the id to be evaluated at compile time */
+template<uint16_t ID>
+struct BinLogId {
+   enum {
+      VALUE = ID
+   };
+};
+
+/**
+ * log a message with up to BinLog::MAX_ARGS arguments
+ *  - e.g., BLOG("adc ch %d: %.3f V", n, reading);
+ */
+#define BLOG(fmt, ...) \
+   bin_log.put((uint16_t) BinLogId<bin_log_id(fmt)>::VALUE, ##__VA_ARGS__)
+
+/**
+ * binary log ring buffer
+ *  - a record is stored only if it fits entirely (after escaping);
+ *    otherwise it is counted as dropped
+ */
+class BinLog {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      BUF_SIZE = 1024,  /**< ring size (power of 2) */
+      MAX_ARGS = 8,     /**< max # arguments per record */
+      MAX_REC = 1 + 2 + 5 + 5 * MAX_ARGS,  /**< max record bytes */
+      SYNC = 0xff,      /**< record start byte */
+      ESC = 0xfe        /**< escape prefix of 0xfe/0xff record bytes */
+   };
+
+   BinLog();
+   ~BinLog();  // not used
+
+   /**
+    * store a record (use BLOG() instead)
+    *
+    * @param id message id
+    * @param args integer or floating-point arguments
+    */
+   template<typename ... Args>
+   void put(uint16_t id, Args ... args) {
+      uint8_t rec[MAX_REC];
+      int n;
+
+      static_assert(sizeof...(Args) <= MAX_ARGS, "too many BLOG arguments");
+      n = begin(rec, id);
+      n = pack(rec, n, args...);
+      commit(rec, n);
+   }
+
+   /**
+    * send all pending records via "uart" (blocking)
+    *
+    * @return # bytes sent
+    */
+   int flush();
+
+   /**
+    * # bytes waiting in the ring
+    */
+   int pending();
+
+   /**
+    * # records dropped because the ring was full
+    */
+   uint32_t dropped();
+
+   /**
+    * # record bytes generated so far (as sent, including escapes)
+    */
+   uint32_t bytes();
+
+private:
+   uint8_t buf[BUF_SIZE];
+   uint32_t head;        // free running write count
+   uint32_t tail;        // free running read count
+   uint32_t last_us;     // time stamp of the previous record
+   uint32_t drop_cnt;
+   uint32_t byte_cnt;
+   int begin(uint8_t *rec, uint16_t id);
+   void commit(const uint8_t *rec, int n);
+   static int varint(uint8_t *p, uint32_t v);
+   /* argument encoders */
+   static int enc(uint8_t *p, int v);
+   static int enc(uint8_t *p, unsigned int v);
+   static int enc(uint8_t *p, long v);
+   static int enc(uint8_t *p, unsigned long v);
+   static int enc(uint8_t *p, double v);
+   static int pack(uint8_t *, int n) {
+      return (n);
+   }
+   template<typename T, typename ... Rest>
+   static int pack(uint8_t *rec, int n, T v, Rest ... rest) {
+      n = n + enc(rec + n, v);
+      return (pack(rec, n, rest...));
+   }
+};
+
+// global log instance
+extern BinLog bin_log;
+
+#endif  // _BIN_LOG_H_INCLUDED
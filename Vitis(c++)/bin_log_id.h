@@ -0,0 +1,39 @@
+/*****************************************************************//**
+ * @file bin_log_id.h
+ *
+ * @brief Compile-time message id of a binary log format string
+ *
+ * Description:
+ *  - 32-bit FNV-1a hash of the format string folded to 16 bits
+ *  - constexpr (C++11), so the id is a constant at each call site
+ *  - shared by the target (bin_log.h) and the host decoder
+ *    (tools/log_decode.cpp); both must hash the same bytes
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _BIN_LOG_ID_H_INCLUDED
+#define _BIN_LOG_ID_H_INCLUDED
+
+#include <inttypes.h>
+
+constexpr uint32_t bin_log_fnv(const char *s, uint32_t h) {
+   return (*s ? bin_log_fnv(s + 1, (h ^ (uint8_t) *s) * 16777619u) : h);
+}
+
+constexpr uint16_t bin_log_fold(uint32_t h) {
+   return ((uint16_t) ((h >> 16) ^ (h & 0xffff)));
+}
+
+/**
+ * message id of a format string
+ *
+ * @param fmt format string
+ * @return 16-bit id
+ */
+constexpr uint16_t bin_log_id(const char *fmt) {
+   return (bin_log_fold(bin_log_fnv(fmt, 2166136261u)));
+}
+
+#endif  // _BIN_LOG_ID_H_INCLUDED
@@ -31,7 +31,17 @@ unsigned long now_us() {
 
 // current system time in ms
 unsigned long now_ms() {
-   return ((unsigned long) _sys_timer.read_time() / 1000);
+   return ((unsigned long) _sys_timer.read_time_ms());
+}
+
+// current system time in clock ticks
+uint64_t now_tick() {
+   return (_sys_timer.read_tick());
+}
+
+// lower word of system clock ticks
+uint32_t now_tick_lo() {
+   return (_sys_timer.read_tick_lo());
 }
 
 // idle for t microseconds
@@ -45,20 +55,8 @@ void sleep_ms(unsigned long int t) {
 }
 
 // debug asserted
-// uart print a 1-line message: msg + 2 numbers in dec/hex format
+// print a 1-line message: msg + 2 numbers via the log sink
 void debug_on(const char *str, int n1, int n2) {
-   uart.disp("debug: ");
-   uart.disp(str);
-   uart.disp(n1);
-   uart.disp("(0x");
-   uart.disp(n1, 16);
-   uart.disp(") / ");
-   uart.disp(n2);
-   uart.disp("(0x");
-   uart.disp(n2, 16);
-   uart.disp(") \n\r");
-}
-
-void debug_off() {
+   log_emit(LOG_MOD_APP, LOG_DEBUG, str, n1, n2);
 }
 
@@ -14,6 +14,7 @@
  *  - "uart" can be used as the default char stream port
  *  - timer core and uart core must be instantiated in slots 0 and 1
  *  - debug() macro print a message when _DEBUG defined
+ *  - leveled per-module logging in chu_log.h
  *
  *
  * @author p chu
@@ -55,6 +56,18 @@ unsigned long now_us();
  */
 unsigned long now_ms();
 
+/**
+ * Current system "up time" in clock ticks (1/SYS_CLK_FREQ us).
+ * @note used for cycle-count measurement
+ */
+uint64_t now_tick();
+
+/**
+ * Lower 32 bits of the system clock tick count.
+ * @note one MMIO read; wraps in 2^32 ticks (about 43 s at 100 MHz)
+ */
+uint32_t now_tick_lo();
+
 /**
  * idle for t microsecond.
  * @param t idle time
@@ -70,21 +83,16 @@ void sleep_ms(unsigned long int t);
 
 /**********************************************************************
  * debug(): function to facilitate debugging
- *  - send a one0line message via "uart"
+ *  - send a one0line message via the log sink (see chu_log.h)
  *  - controlled by _DEBUG
  *  - _DEBUG must be defined in individual file
- *  - replaced with debug_off() when _DEBUG not defined
+ *  - expands to nothing when _DEBUG not defined (arguments not evaluated)
  *  - replaced with debug_on() when _DEBUG defined
  *  - debug_on()print a 1-line message (a string plus 2 numbers)
+ *  - new code should use log_dbg() etc. with a module id
  *
  *********************************************************************/
 
-/**
- * dummy function.
- @note substitute debug() when _DEBUG is not defined
- */
-void debug_off();
-
 /**
  * print a one line message (string plus 2 numbers).
  * @param str a string
@@ -95,13 +103,19 @@ void debug_off();
 void debug_on(const char *str, int n1, int n2);
 
 #ifndef _DEBUG
-#define debug(str, n1, n2) debug_off()
-#endif // not _DEBUG#ifdef _DEBUG
+#define debug(str, n1, n2) ((void) 0)
+#endif // not _DEBUG
+
+#ifdef _DEBUG
 #define debug(str, n1, n2) debug_on((str), (n1), (n2))
-#endif // not _DEBUG#ifdef __cplusplus
+#endif // not _DEBUG
+
+#ifdef __cplusplus
 } // extern "C"
 #endif
 
+#include "chu_log.h"
+
 /**********************************************************************
  * low-level bit-manipulation macros
  * @param n bit position
@@ -22,7 +22,25 @@ extern "C" {
  *  - must bypass data cache for I/O access
  *  - may be replaced with vendor provided macros
  *   (if _VENDOR_IO_ACCESS_USED is defined)
+ *  - _HOST_SIM routes all access to the simulated bus in chu_io_sim.cpp
  *********************************************************************/
+#ifdef _HOST_SIM
+#define _VENDOR_IO_ACCESS_USED
+
+/**
+ * simulated bus read/write (byte address); see chu_io_sim.h
+ */
+uint32_t sim_io_read(uint32_t addr);
+void sim_io_write(uint32_t addr, uint32_t data);
+
+#define io_read(base_addr, offset) \
+   sim_io_read((base_addr) + 4*(offset))
+
+#define io_write(base_addr, offset, data) \
+   sim_io_write((base_addr) + 4*(offset), (uint32_t) (data))
+
+#endif  // _HOST_SIM
+
 #ifndef _VENDOR_IO_ACCESS_USED
 
 /**
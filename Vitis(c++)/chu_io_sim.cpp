@@ -0,0 +1,531 @@
+/*****************************************************************//**
+ * @file chu_io_sim.cpp
+ *
+ * @brief implementation of the host-side simulated MMIO bus
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifdef _HOST_SIM
+
+#include <stdio.h>
+#include <time.h>
+#include "chu_io_sim.h"
+
+/**********************************************************************
+ * bus state
+ *  - slot/register decoding follows chu_mmio_controller.sv:
+ *    2^6 slots, 2^5 32-bit registers per slot
+ **********************************************************************/
+enum {
+   NUM_SLOTS = 64
+};
+
+static uint64_t bus_clk = 0;        // virtual bus clock
+static uint32_t access_clks = 4;    // clocks per MMIO access
+static int host_clock = 0;          // add host elapsed time to bus_clk
+static uint64_t host_last_ns;
+static uint32_t rd_cnt[NUM_SLOTS];
+static uint32_t wr_cnt[NUM_SLOTS];
+static SimSlot *slot_tab[NUM_SLOTS];
+static SimTimer *def_timer;
+static SimUart *def_uart;
+static SimPs2 *def_ps2;
+
+// create the default models on first use
+// (driver constructors access the bus during static initialization)
+static void sim_init() {
+   static int done = 0;
+   static SimSlot generic[NUM_SLOTS];
+   static SimTimer timer;
+   static SimUart uart;
+   static SimSpi spi;
+   static SimI2c i2c;
+   static SimPs2 ps2;
+   int i;
+
+   if (done)
+      return;
+   done = 1;
+   for (i = 0; i < NUM_SLOTS; i++)
+      slot_tab[i] = &generic[i];
+   slot_tab[S0_SYS_TIMER] = &timer;
+   slot_tab[S1_UART1] = &uart;
+   slot_tab[S9_SPI] = &spi;
+   slot_tab[S10_I2C] = &i2c;
+   slot_tab[S11_PS2] = &ps2;
+   def_timer = &timer;
+   def_uart = &uart;
+   def_ps2 = &ps2;
+}
+
+// convert a time in microsecond to bus clocks
+static uint64_t us2clk(uint32_t us) {
+   return ((uint64_t) us * SYS_CLK_FREQ);
+}
+
+// host monotonic time in nanosecond
+static uint64_t host_ns() {
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec);
+}
+
+// advance bus clock for one access
+static void bus_tick() {
+   uint64_t now;
+
+   bus_clk += access_clks;
+   if (host_clock) {
+      now = host_ns();
+      bus_clk += (now - host_last_ns) * SYS_CLK_FREQ / 1000;
+      host_last_ns = now;
+   }
+}
+
+/**********************************************************************
+ * bus access (called via io_read()/io_write() macros)
+ **********************************************************************/
+uint32_t sim_io_read(uint32_t addr) {
+   uint32_t offset;
+   int slot;
+
+   sim_init();
+   bus_tick();
+   offset = addr - BRIDGE_BASE;
+   if (offset >= NUM_SLOTS * 32 * 4)  // video space not modeled
+      return (0);
+   slot = (int) (offset >> 7);
+   rd_cnt[slot]++;
+   return (slot_tab[slot]->read((int) (offset >> 2) & 0x1f));
+}
+
+void sim_io_write(uint32_t addr, uint32_t data) {
+   uint32_t offset;
+   int slot;
+
+   sim_init();
+   bus_tick();
+   offset = addr - BRIDGE_BASE;
+   if (offset >= NUM_SLOTS * 32 * 4)
+      return;
+   slot = (int) (offset >> 7);
+   wr_cnt[slot]++;
+   slot_tab[slot]->write((int) (offset >> 2) & 0x1f, data);
+}
+
+/**********************************************************************
+ * simulation control
+ **********************************************************************/
+void sim_attach(int slot, SimSlot *model) {
+   sim_init();
+   slot_tab[slot] = model;
+}
+
+SimSlot *sim_slot(int slot) {
+   sim_init();
+   return (slot_tab[slot]);
+}
+
+SimTimer *sim_timer() {
+   sim_init();
+   return (def_timer);
+}
+
+SimUart *sim_uart() {
+   sim_init();
+   return (def_uart);
+}
+
+SimPs2 *sim_ps2() {
+   sim_init();
+   return (def_ps2);
+}
+
+uint64_t sim_clock() {
+   return (bus_clk);
+}
+
+void sim_advance(uint64_t clks) {
+   bus_clk += clks;
+}
+
+void sim_set_access_clks(uint32_t clks) {
+   access_clks = clks;
+}
+
+void sim_set_host_clock(int on) {
+   host_clock = on;
+   host_last_ns = host_ns();
+}
+
+uint32_t sim_reads(int slot) {
+   uint32_t sum = 0;
+   int i;
+
+   if (slot >= 0)
+      return (rd_cnt[slot]);
+   for (i = 0; i < NUM_SLOTS; i++)
+      sum += rd_cnt[i];
+   return (sum);
+}
+
+uint32_t sim_writes(int slot) {
+   uint32_t sum = 0;
+   int i;
+
+   if (slot >= 0)
+      return (wr_cnt[slot]);
+   for (i = 0; i < NUM_SLOTS; i++)
+      sum += wr_cnt[i];
+   return (sum);
+}
+
+void sim_clear_stats() {
+   int i;
+
+   for (i = 0; i < NUM_SLOTS; i++) {
+      rd_cnt[i] = 0;
+      wr_cnt[i] = 0;
+   }
+}
+
+/**********************************************************************
+ * SimSlot: generic register file
+ **********************************************************************/
+SimSlot::SimSlot() {
+   int i;
+
+   for (i = 0; i < NUM_REGS; i++)
+      regs[i] = 0;
+}
+
+SimSlot::~SimSlot() {
+}
+
+uint32_t SimSlot::read(int reg) {
+   return (regs[reg]);
+}
+
+void SimSlot::write(int reg, uint32_t data) {
+   regs[reg] = data;
+}
+
+uint32_t SimSlot::peek(int reg) {
+   return (regs[reg]);
+}
+
+void SimSlot::poke(int reg, uint32_t data) {
+   regs[reg] = data;
+}
+
+/**********************************************************************
+ * SimTimer: reg 0/1 counter low/high, reg 2 go/clear (chu_timer.sv)
+ **********************************************************************/
+SimTimer::SimTimer() {
+   base = 0;
+   stamp = bus_clk;
+   go = 0;
+}
+
+uint64_t SimTimer::count() {
+   uint64_t c = base;
+
+   if (go)
+      c = c + (bus_clk - stamp);
+   return (c & 0x0000ffffffffffffULL);   // 48-bit counter
+}
+
+void SimTimer::set_count(uint64_t c) {
+   base = c;
+   stamp = bus_clk;
+}
+
+uint32_t SimTimer::read(int reg) {
+   if ((reg & 0x01) == 0)
+      return ((uint32_t) count());
+   return ((uint32_t) (count() >> 32));
+}
+
+void SimTimer::write(int reg, uint32_t data) {
+   if ((reg & 0x03) != 2)
+      return;
+   base = count();
+   stamp = bus_clk;
+   go = (int) (data & 0x01);
+   if (data & 0x02)
+      base = 0;
+}
+
+/**********************************************************************
+ * SimUart: reg 0 {tx_full, rx_empty, data}, 1 dvsr, 2 wr, 3 rm rd
+ **********************************************************************/
+SimUart::SimUart() {
+   rx_head = 0;
+   rx_num = 0;
+   tx_num = 0;
+   tx_stamp = 0;
+   dvsr = 0;
+   tx_total = 0;
+   tx_drop = 0;
+   echo = 1;
+}
+
+// remove transmitted bytes (10 bits of 16 ticks each) from tx fifo
+void SimUart::drain() {
+   uint64_t byte_clks = 160 * (uint64_t) (dvsr + 1);
+
+   while (tx_num > 0 && bus_clk - tx_stamp >= byte_clks) {
+      tx_num--;
+      tx_stamp += byte_clks;
+   }
+}
+
+uint32_t SimUart::read(int) {
+   uint32_t word = 0;
+
+   drain();
+   if (tx_num >= FIFO_DEPTH)
+      word = word | 0x200;
+   if (rx_num == 0)
+      word = word | 0x100;
+   else
+      word = word | rx_buf[rx_head];
+   return (word);
+}
+
+void SimUart::write(int reg, uint32_t data) {
+   drain();
+   switch (reg & 0x03) {
+   case 1:
+      dvsr = data & 0x7ff;
+      break;
+   case 2:
+      tx_total++;
+      if (tx_num >= FIFO_DEPTH) {
+         tx_drop++;     // hardware fifo ignores write when full
+         break;
+      }
+      if (tx_num == 0)
+         tx_stamp = bus_clk;
+      tx_num++;
+      if (echo)
+         putchar((int) (data & 0xff));
+      break;
+   case 3:
+      if (rx_num > 0) {
+         rx_head = (rx_head + 1) % FIFO_DEPTH;
+         rx_num--;
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+void SimUart::rx_push(uint8_t byte) {
+   if (rx_num < FIFO_DEPTH) {
+      rx_buf[(rx_head + rx_num) % FIFO_DEPTH] = byte;
+      rx_num++;
+   }
+}
+
+void SimUart::set_echo(int on) {
+   echo = on;
+}
+
+uint32_t SimUart::tx_count() {
+   return (tx_total);
+}
+
+uint32_t SimUart::tx_lost() {
+   return (tx_drop);
+}
+
+/**********************************************************************
+ * SimSpi: reg 0 {ready, data}, 1 ss_n, 2 wr data, 3 ctrl (dvsr 15-0)
+ **********************************************************************/
+SimSpi::SimSpi() {
+   ss_n = 0xffffffff;
+   done_clk = 0;
+   miso = 0;
+}
+
+uint32_t SimSpi::read(int) {
+   uint32_t word = miso;
+
+   if (bus_clk >= done_clk)
+      word = word | 0x100;
+   return (word);
+}
+
+void SimSpi::write(int reg, uint32_t data) {
+   uint32_t dvsr;
+
+   switch (reg & 0x03) {
+   case 1:
+      ss_n = data;
+      break;
+   case 2:
+      dvsr = regs[3] & 0xffff;
+      done_clk = bus_clk + 8 * 2 * (uint64_t) (dvsr + 1);
+      miso = xfer((uint8_t) data);
+      break;
+   case 3:
+      regs[3] = data;
+      break;
+   default:
+      break;
+   }
+}
+
+uint8_t SimSpi::xfer(uint8_t mosi) {
+   return (mosi);
+}
+
+/**********************************************************************
+ * SimI2c: reg 0 wr dvsr / rd {ack, ready, data}, reg 1 cmd/data
+ **********************************************************************/
+SimI2c::SimI2c() {
+   done_clk = 0;
+   dvsr = 0;
+   rd_byte = 0;
+   ack = 0;
+   first = 0;
+}
+
+uint32_t SimI2c::read(int) {
+   uint32_t word = rd_byte;
+
+   if (bus_clk >= done_clk)
+      word = word | 0x100;
+   if (ack)
+      word = word | 0x200;
+   return (word);
+}
+
+void SimI2c::write(int reg, uint32_t data) {
+   uint32_t quarters;
+
+   if ((reg & 0x01) == 0) {
+      dvsr = data;
+      return;
+   }
+   switch ((data >> 8) & 0x07) {
+   case 0:   // start
+   case 4:   // restart
+      first = 1;
+      quarters = 2 * 4;
+      break;
+   case 1:   // write
+      ack = dev_write((uint8_t) data, first);
+      first = 0;
+      quarters = 9 * 4;
+      break;
+   case 2:   // read
+      rd_byte = dev_read();
+      quarters = 9 * 4;
+      break;
+   default:  // stop
+      quarters = 2 * 4;
+      break;
+   }
+   done_clk = bus_clk + quarters * (uint64_t) dvsr;
+}
+
+int SimI2c::dev_write(uint8_t, int) {
+   return (0);
+}
+
+uint8_t SimI2c::dev_read() {
+   return (0xff);
+}
+
+/**********************************************************************
+ * SimPs2: reg 0 {tx_idle, rx_empty, data}, 2 wr data, 3 rm rd
+ **********************************************************************/
+SimPs2::SimPs2() {
+   rx_head = 0;
+   rx_num = 0;
+   tx_done_clk = 0;
+   reset_ms = 500;
+   cmd = -1;
+   nack = 0;
+}
+
+uint32_t SimPs2::read(int) {
+   uint32_t word = 0;
+
+   if (bus_clk >= tx_done_clk)
+      word = word | 0x200;
+   if (rx_num == 0 || rx_clk[rx_head] > bus_clk)
+      word = word | 0x100;
+   else
+      word = word | rx_buf[rx_head];
+   return (word);
+}
+
+void SimPs2::write(int reg, uint32_t data) {
+   switch (reg & 0x03) {
+   case 2:
+      cmd = (int) (data & 0xff);
+      tx_done_clk = bus_clk + us2clk(1100);  // 11 bits at ~10 kHz
+      host_cmd((uint8_t) cmd);
+      break;
+   case 3:
+      if (rx_num > 0 && rx_clk[rx_head] <= bus_clk) {
+         rx_head = (rx_head + 1) % FIFO_DEPTH;
+         rx_num--;
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+void SimPs2::rx_push(uint8_t byte, uint32_t delay_us) {
+   uint64_t t;
+   int tail;
+
+   if (rx_num >= FIFO_DEPTH)
+      return;
+   t = bus_clk + us2clk(delay_us);
+   // bytes arrive in order
+   if (rx_num > 0) {
+      tail = (rx_head + rx_num - 1) % FIFO_DEPTH;
+      if (t < rx_clk[tail])
+         t = rx_clk[tail];
+   }
+   tail = (rx_head + rx_num) % FIFO_DEPTH;
+   rx_buf[tail] = byte;
+   rx_clk[tail] = t;
+   rx_num++;
+}
+
+void SimPs2::host_cmd(uint8_t c) {
+   if (nack > 0) {
+      nack--;
+      rx_push(0xfe, 2000);                // resend
+   } else if (c == 0xff) {
+      rx_push(0xfa, 2000);                // ack
+      rx_push(0xaa, reset_ms * 1000);     // self test passed
+   } else {
+      rx_push(0xfa, 2000);
+   }
+}
+
+void SimPs2::set_reset_ms(uint32_t ms) {
+   reset_ms = ms;
+}
+
+void SimPs2::set_nack(int n) {
+   nack = n;
+}
+
+int SimPs2::last_cmd() {
+   return (cmd);
+}
+
+#endif  // _HOST_SIM
@@ -0,0 +1,331 @@
+/*****************************************************************//**
+ * @file chu_io_sim.h
+ *
+ * @brief Host-side simulated MMIO bus for off-board driver runs
+ *
+ * Description:
+ *  - enabled by defining _HOST_SIM when compiling all files
+ *  - io_read()/io_write() are redirected (via _VENDOR_IO_ACCESS_USED
+ *    in chu_io_rw.h) to sim_io_read()/sim_io_write()
+ *  - each of the 14 slots in chu_io_map.h is backed by a register model
+ *  - a model can be replaced with sim_attach() (e.g., to emulate a sensor)
+ *  - a virtual bus clock advances sim access clocks per MMIO access;
+ *    the slot 0 timer model counts this clock, so TimerCore, now_us()
+ *    and sleep_ms() work unchanged
+ *  - per-slot read/write counters for cost measurement
+ *  - optional host-time clock to time cpu-bound code on the host
+ *  - host build example (from the repository root):
+ *      g++ -O2 -D_HOST_SIM -I"Vitis(c++)" main_sampler_test.cpp "Vitis(c++)"/[a-z]*.cpp
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_IO_SIM_H_INCLUDED
+#define _CHU_IO_SIM_H_INCLUDED
+
+#include "chu_io_rw.h"
+#include "chu_io_map.h"
+
+/**********************************************************************
+ * simulated slot models
+ **********************************************************************/
+/**
+ * generic slot model
+ *  - 32-word register file; read returns the last written/poked value
+ *  - used for gpo, gpi, xadc, pwm, debounce, sseg, ddfs and adsr slots
+ *  - derive from it to model a core with side effects
+ */
+class SimSlot {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      NUM_REGS = 32  /**< # registers per slot (5-bit reg address) */
+   };
+   SimSlot();
+   virtual ~SimSlot();
+
+   /**
+    * bus read access
+    * @param reg register offset (0 to 31)
+    * @return 32-bit register data
+    */
+   virtual uint32_t read(int reg);
+
+   /**
+    * bus write access
+    * @param reg register offset (0 to 31)
+    * @param data 32-bit write data
+    */
+   virtual void write(int reg, uint32_t data);
+
+   /**
+    * inspect a register without a bus access (host check)
+    * @param reg register offset
+    */
+   uint32_t peek(int reg);
+
+   /**
+    * set a register without a bus access (e.g., switch/adc input)
+    * @param reg register offset
+    * @param data 32-bit data
+    */
+   void poke(int reg, uint32_t data);
+
+protected:
+   uint32_t regs[NUM_REGS];
+};
+
+/**
+ * timer model (slot 0)
+ *  - 48-bit counter driven by the virtual bus clock
+ */
+class SimTimer: public SimSlot {
+public:
+   SimTimer();
+   uint32_t read(int reg);
+   void write(int reg, uint32_t data);
+
+   /**
+    * preset the counter (e.g., just below a 32-bit wrap)
+    * @param count new counter value
+    */
+   void set_count(uint64_t count);
+
+private:
+   uint64_t count();
+   uint64_t base;      // counter value at last update
+   uint64_t stamp;     // bus clock at last update
+   int go;
+};
+
+/**
+ * uart model (slot 1)
+ *  - 256-entry tx fifo drained at the programmed baud rate
+ *  - transmitted bytes are copied to the host stdout
+ *  - rx bytes injected with rx_push()
+ */
+class SimUart: public SimSlot {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      FIFO_DEPTH = 256  /**< FIFO_DEPTH_BIT(8) in mmio_sys_sampler.sv */
+   };
+   SimUart();
+   uint32_t read(int reg);
+   void write(int reg, uint32_t data);
+
+   /**
+    * inject a byte into the rx fifo
+    * @param byte received data
+    */
+   void rx_push(uint8_t byte);
+
+   /**
+    * suppress (0) or enable (1) copying tx bytes to host stdout
+    */
+   void set_echo(int on);
+
+   /**
+    * # bytes written into the tx fifo (including dropped ones)
+    */
+   uint32_t tx_count();
+
+   /**
+    * # bytes lost because the tx fifo was full
+    */
+   uint32_t tx_lost();
+
+private:
+   void drain();
+   uint8_t rx_buf[FIFO_DEPTH];
+   int rx_head, rx_num;
+   int tx_num;          // current tx fifo occupancy
+   uint64_t tx_stamp;   // bus clock when the head byte started
+   uint32_t dvsr;
+   uint32_t tx_total, tx_drop;
+   int echo;
+};
+
+/**
+ * spi model (slot 9)
+ *  - a transfer takes 8 sclk periods; ready is 0 meanwhile
+ *  - override xfer() to emulate a slave (default: loopback)
+ */
+class SimSpi: public SimSlot {
+public:
+   SimSpi();
+   uint32_t read(int reg);
+   void write(int reg, uint32_t data);
+
+   /**
+    * slave response to one transferred byte
+    * @param mosi byte from master
+    * @return byte to master
+    */
+   virtual uint8_t xfer(uint8_t mosi);
+
+protected:
+   uint32_t ss_n;       // current slave select lines
+private:
+   uint64_t done_clk;   // bus clock when the current transfer completes
+   uint8_t miso;
+};
+
+/**
+ * i2c model (slot 10)
+ *  - each command occupies the bus for 9 (byte) or 2 (start/stop) sclks
+ *  - override dev_write()/dev_read() to emulate a slave
+ */
+class SimI2c: public SimSlot {
+public:
+   SimI2c();
+   uint32_t read(int reg);
+   void write(int reg, uint32_t data);
+
+   /**
+    * slave receives a byte
+    * @param byte data from master (1st byte after start is dev/rw)
+    * @param first 1 if byte follows a start/restart
+    * @return 0: ack; 1: nack
+    */
+   virtual int dev_write(uint8_t byte, int first);
+
+   /**
+    * slave sends a byte
+    * @return data to master
+    */
+   virtual uint8_t dev_read();
+
+private:
+   uint64_t done_clk;
+   uint32_t dvsr;
+   uint8_t rd_byte;
+   int ack;
+   int first;
+};
+
+/**
+ * ps2 model (slot 11)
+ *  - rx fifo with per-byte arrival time (rx_push())
+ *  - sending a byte takes about 1 ms; tx_idle is 0 meanwhile
+ *  - default device is a keyboard: 0xff -> 0xfa 0xaa after reset_ms;
+ *    other commands -> 0xfa; override host_cmd() for other behavior
+ *  - set_nack(n): the next n host bytes are answered 0xfe (resend)
+ */
+class SimPs2: public SimSlot {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      FIFO_DEPTH = 256
+   };
+   SimPs2();
+   uint32_t read(int reg);
+   void write(int reg, uint32_t data);
+
+   /**
+    * inject a byte that arrives delay_us from now
+    * @param byte data from device
+    * @param delay_us arrival delay in microsecond
+    */
+   void rx_push(uint8_t byte, uint32_t delay_us);
+
+   /**
+    * device response to a host command byte
+    * @param cmd byte sent by the host
+    */
+   virtual void host_cmd(uint8_t cmd);
+
+   /**
+    * set device reset (BAT) latency
+    * @param ms latency in millisecond
+    */
+   void set_reset_ms(uint32_t ms);
+
+   /**
+    * answer the next n host bytes with 0xfe (resend request)
+    * @param n # bytes
+    */
+   void set_nack(int n);
+
+   /**
+    * last byte sent by the host
+    */
+   int last_cmd();
+
+private:
+   uint8_t rx_buf[FIFO_DEPTH];
+   uint64_t rx_clk[FIFO_DEPTH];
+   int rx_head, rx_num;
+   uint64_t tx_done_clk;
+   uint32_t reset_ms;
+   int cmd;
+   int nack;
+};
+
+/**********************************************************************
+ * simulation control
+ **********************************************************************/
+/**
+ * replace the model of a slot
+ * @param slot slot # (0 to 63)
+ * @param model pointer to the new model (owned by the caller)
+ */
+void sim_attach(int slot, SimSlot *model);
+
+/**
+ * get the model of a slot
+ * @param slot slot #
+ */
+SimSlot *sim_slot(int slot);
+
+/**
+ * direct access to the default models
+ */
+SimTimer *sim_timer();
+SimUart *sim_uart();
+SimPs2 *sim_ps2();
+
+/**
+ * current virtual bus clock (# SYS_CLK_FREQ clocks since start)
+ */
+uint64_t sim_clock();
+
+/**
+ * advance the virtual bus clock (e.g., to model cpu work)
+ * @param clks # clocks
+ */
+void sim_advance(uint64_t clks);
+
+/**
+ * set # bus clocks consumed by one MMIO access (default 4)
+ */
+void sim_set_access_clks(uint32_t clks);
+
+/**
+ * also advance the bus clock with host elapsed time
+ * @param on 1: host time scaled to SYS_CLK_FREQ is added on each access;
+ *           0: clock advances only per access (default)
+ * @note used to measure cpu-bound code with now_tick() on the host
+ */
+void sim_set_host_clock(int on);
+
+/**
+ * # MMIO reads/writes of a slot since last sim_clear_stats()
+ * @param slot slot #; -1 for all slots
+ */
+uint32_t sim_reads(int slot);
+uint32_t sim_writes(int slot);
+
+/**
+ * clear the access counters
+ */
+void sim_clear_stats();
+
+#endif  // _CHU_IO_SIM_H_INCLUDED
@@ -0,0 +1,37 @@
+/*****************************************************************//**
+ * @file chu_log.cpp
+ *
+ * @brief implementation of log sink selection and default uart sink
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_init.h"
+
+static LogSink log_sink = log_uart_sink;
+
+void log_set_sink(LogSink sink) {
+   log_sink = sink ? sink : log_uart_sink;
+}
+
+void log_emit(int mod, int level, const char *str, int n1, int n2) {
+   log_sink(mod, level, str, n1, n2);
+}
+
+// uart print a 1-line message: level + msg + 2 numbers in dec/hex format
+void log_uart_sink(int, int level, const char *str, int n1, int n2) {
+   static const char *const TAG[] = { "", "error: ", "warn: ", "info: ",
+         "debug: " };
+
+   uart.disp(TAG[(level >= LOG_ERR && level <= LOG_DEBUG) ? level : 0]);
+   uart.disp(str);
+   uart.disp(n1);
+   uart.disp("(0x");
+   uart.disp(n1, 16);
+   uart.disp(") / ");
+   uart.disp(n2);
+   uart.disp("(0x");
+   uart.disp(n2, 16);
+   uart.disp(") \n\r");
+}
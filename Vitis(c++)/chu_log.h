@@ -0,0 +1,145 @@
+/*****************************************************************//**
+ * @file chu_log.h
+ *
+ * @brief Leveled logging with per-module compile-time levels
+ *
+ * Description:
+ *  - log_err()/log_warn()/log_info()/log_dbg(mod, str, n1, n2)
+ *    print a string plus 2 numbers (same shape as debug())
+ *  - each module has a compile-time level; a statement above the
+ *    level is a constant-false "if": no call and no argument
+ *    evaluation are left in the code
+ *  - default level LOG_LEVEL (LOG_WARN); override per module on the
+ *    command line, e.g., -DLOG_LEVEL_PS2=LOG_DEBUG or -DLOG_LEVEL=4
+ *  - enabled statements go to a sink selected with log_set_sink();
+ *    the default sink prints a line via "uart"
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_LOG_H_INCLUDED
+#define _CHU_LOG_H_INCLUDED
+
+/**
+ * log levels (numeric so they can be given with -D)
+ */
+#define LOG_NONE  0
+#define LOG_ERR   1
+#define LOG_WARN  2
+#define LOG_INFO  3
+#define LOG_DEBUG 4
+
+/**
+ * module ids
+ */
+enum {
+   LOG_MOD_APP = 0,  /**< application (main program) */
+   LOG_MOD_PWM,      /**< PwmCore */
+   LOG_MOD_ADSR,     /**< AdsrCore */
+   LOG_MOD_PS2,      /**< Ps2Core */
+   LOG_NUM_MODS
+};
+
+/* default levels */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_WARN
+#endif
+#ifndef LOG_LEVEL_APP
+#define LOG_LEVEL_APP LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_PWM
+#define LOG_LEVEL_PWM LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_ADSR
+#define LOG_LEVEL_ADSR LOG_LEVEL
+#endif
+#ifndef LOG_LEVEL_PS2
+#define LOG_LEVEL_PS2 LOG_LEVEL
+#endif
+
+/**
+ * compile-time level of a module
+ *  - add a specialization with each new module id
+ */
+template<int MOD>
+struct LogModule;
+template<>
+struct LogModule<LOG_MOD_APP> {
+   enum {
+      LEVEL = LOG_LEVEL_APP
+   };
+};
+template<>
+struct LogModule<LOG_MOD_PWM> {
+   enum {
+      LEVEL = LOG_LEVEL_PWM
+   };
+};
+template<>
+struct LogModule<LOG_MOD_ADSR> {
+   enum {
+      LEVEL = LOG_LEVEL_ADSR
+   };
+};
+template<>
+struct LogModule<LOG_MOD_PS2> {
+   enum {
+      LEVEL = LOG_LEVEL_PS2
+   };
+};
+
+/**
+ * compile-time check of a statement level against its module level
+ */
+template<int MOD, int LVL>
+struct LogEnabled {
+   enum {
+      VALUE = (LVL <= LogModule<MOD>::LEVEL)
+   };
+};
+
+/**
+ * sink function type
+ * @param mod module id
+ * @param level log level
+ * @param str message string
+ * @param n1 first number
+ * @param n2 second number
+ */
+typedef void (*LogSink)(int mod, int level, const char *str, int n1, int n2);
+
+/**
+ * select the sink of enabled statements
+ *
+ * @param sink sink function; 0 restores the default uart sink
+ */
+void log_set_sink(LogSink sink);
+
+/**
+ * pass a message to the current sink (used by the log macros)
+ */
+void log_emit(int mod, int level, const char *str, int n1, int n2);
+
+/**
+ * default sink: "<level>: str n1(0xn1) / n2(0xn2)" via "uart"
+ */
+void log_uart_sink(int mod, int level, const char *str, int n1, int n2);
+
+/**********************************************************************
+ * log statements
+ *  - mod: LOG_MOD_xxx; str: string; n1/n2: integers
+ *  - condition is a compile-time constant; a disabled statement
+ *    leaves no code and its arguments are not evaluated
+ *********************************************************************/
+#define log_at(mod, lvl, str, n1, n2) \
+   do { \
+      if (LogEnabled<(mod), (lvl)>::VALUE) \
+         log_emit((mod), (lvl), (str), (n1), (n2)); \
+   } while (0)
+#define log_err(mod, str, n1, n2) log_at(mod, LOG_ERR, str, n1, n2)
+#define log_warn(mod, str, n1, n2) log_at(mod, LOG_WARN, str, n1, n2)
+#define log_info(mod, str, n1, n2) log_at(mod, LOG_INFO, str, n1, n2)
+#define log_dbg(mod, str, n1, n2) log_at(mod, LOG_DEBUG, str, n1, n2)
+
+#endif  // _CHU_LOG_H_INCLUDED
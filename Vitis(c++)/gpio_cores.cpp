@@ -8,12 +8,124 @@
  ********************************************************************/
 
 #include "gpio_cores.h"
+#include "pwm_gamma.h"
+
+/**********************************************************************
+ * color
+ **********************************************************************/
+// a x b / 255, exact at 0 and 255
+static inline uint8_t scale8(uint8_t a, uint8_t b) {
+   return ((uint8_t) (((uint32_t) a * ((uint32_t) b + 1)) >> 8));
+}
+
+PwmRgb pwm_hsv(int hue, int sat, int val) {
+   PwmRgb c;
+   uint8_t v, p, q, t, f;
+
+   // wrap by compare-and-subtract (no divider on the MCS); in-range
+   // hues skip both loops
+   while (hue >= PWM_HUE_MAX)
+      hue = hue - PWM_HUE_MAX;
+   while (hue < 0)
+      hue = hue + PWM_HUE_MAX;
+   v = (uint8_t) val;
+   f = (uint8_t) (hue & (PWM_HUE_SECTOR - 1));    // position in sector
+   p = scale8(v, 255 - sat);
+   q = scale8(v, 255 - scale8(sat, f));            // falling edge
+   t = scale8(v, 255 - scale8(sat, 255 - f));      // rising edge
+   switch ((unsigned) hue / PWM_HUE_SECTOR) {      // shift
+   case 0:
+      c.r = v; c.g = t; c.b = p;
+      break;
+   case 1:
+      c.r = q; c.g = v; c.b = p;
+      break;
+   case 2:
+      c.r = p; c.g = v; c.b = t;
+      break;
+   case 3:
+      c.r = p; c.g = q; c.b = v;
+      break;
+   case 4:
+      c.r = t; c.g = p; c.b = v;
+      break;
+   default:
+      c.r = v; c.g = p; c.b = q;
+   }
+   return (c);
+}
+
+/**********************************************************************
+ * GpiEdgeQueue
+ **********************************************************************/
+GpiEdgeQueue::GpiEdgeQueue() {
+   prev = 0;
+   head = 0;
+   tail = 0;
+}
+GpiEdgeQueue::~GpiEdgeQueue() {
+}
+
+int GpiEdgeQueue::update(uint32_t sample) {
+   uint32_t diff, now;
+   GpiEdge *ev;
+   int i, n;
+
+   diff = sample ^ prev;
+   if (diff == 0)
+      return (0);
+   now = (uint32_t) now_us();   // one time stamp per poll
+   n = 0;
+   for (i = 0; diff != 0; i++, diff = diff >> 1) {
+      if (!(diff & 0x01))
+         continue;
+      if (head - tail == QUEUE_SIZE)
+         tail++;                // overwrite the oldest
+      ev = &q[head & (QUEUE_SIZE - 1)];
+      ev->time_us = now;
+      ev->bit = (uint8_t) i;
+      ev->rising = (uint8_t) bit_read(sample, i);
+      head++;
+      n++;
+   }
+   prev = sample;
+   return (n);
+}
+
+void GpiEdgeQueue::seed(uint32_t sample) {
+   prev = sample;
+}
+
+int GpiEdgeQueue::get(GpiEdge *ev) {
+   if (tail == head)
+      return (0);
+   *ev = q[tail & (QUEUE_SIZE - 1)];
+   tail++;
+   return (1);
+}
+
+int GpiEdgeQueue::first_since(uint32_t t_us, uint32_t mask, GpiEdge *ev) {
+   GpiEdge *e;
+   uint32_t i;
+
+   for (i = tail; i != head; i++) {
+      e = &q[i & (QUEUE_SIZE - 1)];
+      // wrap-safe "time >= t_us"
+      if ((int32_t) (e->time_us - t_us) >= 0 && (mask & bit(e->bit))) {
+         *ev = *e;
+         return (1);
+      }
+   }
+   return (0);
+}
 
 /**********************************************************************
  * GpiCore
  **********************************************************************/
 GpiCore::GpiCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   db_period = 0;
+   db_last = 0;
 }
 GpiCore::~GpiCore() {
 }
@@ -27,6 +139,42 @@ int GpiCore::read(int bit_pos) {
    return ((int) bit_read(rd_data, bit_pos));
 }
 
+int GpiCore::poll() {
+   uint32_t raw, now;
+
+   raw = io_read(base_addr, DATA_REG);
+   if (db_period) {
+      now = (uint32_t) now_us();
+      if (now - db_last < db_period)
+         return (0);          // not yet time for the next sample
+      db_last = now;
+      raw = db.update(raw);
+   }
+   return (edges.update(raw));
+}
+
+void GpiCore::set_debounce(int n, uint32_t period_us) {
+   uint32_t raw;
+
+   raw = io_read(base_addr, DATA_REG);
+   db.init(raw, n);
+   edges.seed(raw);
+   db_last = (uint32_t) now_us();
+   db_period = (n > 0) ? period_us : 0;
+}
+
+uint32_t GpiCore::read_db() {
+   return (db_period ? db.read() : io_read(base_addr, DATA_REG));
+}
+
+int GpiCore::get_edge(GpiEdge *ev) {
+   return (edges.get(ev));
+}
+
+int GpiCore::first_edge_since(uint32_t t_us, uint32_t mask, GpiEdge *ev) {
+   return (edges.first_since(t_us, mask, ev));
+}
+
 /**********************************************************************
  * DebounceCore
  **********************************************************************/
@@ -54,32 +202,94 @@ int DebounceCore::read_db(int bit_pos) {
    return ((int) bit_read(rd_data, bit_pos));
 }
 
+int DebounceCore::poll() {
+   return (edges.update(io_read(base_addr, DB_DATA_REG)));
+}
+
+int DebounceCore::get_edge(GpiEdge *ev) {
+   return (edges.get(ev));
+}
+
+int DebounceCore::first_edge_since(uint32_t t_us, uint32_t mask,
+      GpiEdge *ev) {
+   return (edges.first_since(t_us, mask, ev));
+}
+
 /**********************************************************************
  * GpoCore
  **********************************************************************/
 GpoCore::GpoCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
    wr_data = 0;
+   hw_data = 0;
+   deferred = 0;
 }
 
 GpoCore::~GpoCore() {
 }
 
+// write now, or leave it to flush() in deferred mode
+void GpoCore::commit() {
+   if (deferred)
+      return;
+   hw_data = wr_data;
+   io_write(base_addr, DATA_REG, wr_data);
+}
+
 void GpoCore::write(uint32_t data) {
    wr_data = data;
-   io_write(base_addr, DATA_REG, wr_data);
+   commit();
 }
 
 void GpoCore::write(int bit_value, int bit_pos) {
    bit_write(wr_data, bit_pos, bit_value);
+   commit();
+}
+
+void GpoCore::write_masked(uint32_t mask, uint32_t value) {
+   wr_data = (wr_data & ~mask) | (value & mask);
+   commit();
+}
+
+void GpoCore::set_bits(uint32_t mask) {
+   wr_data = wr_data | mask;
+   commit();
+}
+
+void GpoCore::clear_bits(uint32_t mask) {
+   wr_data = wr_data & ~mask;
+   commit();
+}
+
+void GpoCore::toggle_bits(uint32_t mask) {
+   wr_data = wr_data ^ mask;
+   commit();
+}
+
+void GpoCore::set_deferred(int on) {
+   if (!on)
+      flush();
+   deferred = on;
+}
+
+void GpoCore::flush() {
+   if (wr_data == hw_data)
+      return;
+   hw_data = wr_data;
    io_write(base_addr, DATA_REG, wr_data);
 }
 
+uint32_t GpoCore::read_shadow() {
+   return (wr_data);
+}
+
 /**********************************************************************
  * PwmCore
  **********************************************************************/
 PwmCore::PwmCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   for (int i = 0; i < RGB_LEDS; i++)
+      wb[i].r = wb[i].g = wb[i].b = 255;
    set_freq(1000);
 }
 
@@ -106,7 +316,21 @@ void PwmCore::set_duty(int duty, int channel) {
 void PwmCore::set_duty(double f, int channel) {
    int duty;
    duty = (int) (f * MAX);
-   debug("set_duty_f: ", f, duty);
+   log_dbg(LOG_MOD_PWM, "pwm set_duty_f - channel/duty: ", channel, duty);
    set_duty(duty, channel);
 }
 
+void PwmCore::set_white_balance(PwmRgb gain, int led) {
+   wb[led % RGB_LEDS] = gain;
+}
+
+void PwmCore::set_color(PwmRgb c, int led) {
+   int ch;
+
+   led = led % RGB_LEDS;
+   ch = DUTY_REG_BASE + 3 * led;
+   io_write(base_addr, ch, PwmGamma::LUT[scale8(c.r, wb[led].r)]);
+   io_write(base_addr, ch + 1, PwmGamma::LUT[scale8(c.g, wb[led].g)]);
+   io_write(base_addr, ch + 2, PwmGamma::LUT[scale8(c.b, wb[led].b)]);
+}
+
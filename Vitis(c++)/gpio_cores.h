@@ -13,6 +13,108 @@
 #define _GPIO_H_INCLUDED
 
 #include "chu_init.h"
+#include "vert_debounce.h"
+
+/**********************************************************************
+ * color (used by PwmCore tri-color leds)
+ **********************************************************************/
+/**
+ * 8-bit r/g/b color
+ */
+struct PwmRgb {
+   uint8_t r;  /**< red level */
+   uint8_t g;  /**< green level */
+   uint8_t b;  /**< blue level */
+};
+
+/**
+ * hue scale: 6 sectors (red-yellow-green-cyan-blue-magenta) of 256
+ */
+enum {
+   PWM_HUE_SECTOR = 256,             /**< hue steps per sector */
+   PWM_HUE_MAX = 6 * PWM_HUE_SECTOR  /**< # hue values (one turn) */
+};
+
+/**
+ * convert hsv to rgb (integer only)
+ *
+ * @param hue hue (0 to PWM_HUE_MAX-1; other values wrap, one
+ *        compare-and-subtract pass per turn)
+ * @param sat saturation (0 to 255)
+ * @param val value (0 to 255)
+ * @return rgb color
+ */
+PwmRgb pwm_hsv(int hue, int sat, int val);
+
+/**********************************************************************
+ * input edge events (used by GpiCore and DebounceCore)
+ **********************************************************************/
+/**
+ * input edge event
+ */
+struct GpiEdge {
+   uint32_t time_us;  /**< now_us() of the poll that saw the change */
+   uint8_t bit;       /**< bit position */
+   uint8_t rising;    /**< 1: 0-to-1; 0: 1-to-0 */
+};
+
+/**
+ * edge detector and event queue
+ *  - update() XORs a new sample with the previous one and queues an
+ *    event per changed bit, all with one time stamp
+ *  - when full, the oldest event is overwritten (newest kept)
+ */
+class GpiEdgeQueue {
+public:
+   /**
+    * symbolic constant
+    *
+    */
+   enum {
+      QUEUE_SIZE = 32  /**< # events kept (power of 2) */
+   };
+   GpiEdgeQueue();
+   ~GpiEdgeQueue();   // not used
+
+   /**
+    * compare a sample with the previous one and queue its edges
+    *
+    * @param sample input word
+    * @return # edges queued
+    */
+   int update(uint32_t sample);
+
+   /**
+    * take a sample as the previous one without queueing edges
+    *
+    * @param sample input word
+    */
+   void seed(uint32_t sample);
+
+   /**
+    * remove the oldest event
+    *
+    * @param ev pointer to the event
+    * @return 1: event returned; 0: queue empty
+    */
+   int get(GpiEdge *ev);
+
+   /**
+    * find the first queued edge at or after a time (event kept)
+    *
+    * @param t_us start time (now_us() value)
+    * @param mask bits of interest
+    * @param ev pointer to the event
+    * @return 1: found; 0: none
+    */
+   int first_since(uint32_t t_us, uint32_t mask, GpiEdge *ev);
+
+private:
+   GpiEdge q[QUEUE_SIZE];
+   uint32_t prev;      // previous sample
+   uint32_t head;      // free running
+   uint32_t tail;
+};
 
 /**********************************************************************
  * gpi (general-purpose input) core driver
@@ -20,6 +122,8 @@
 /**
  * gpi (general-purpose input) core driver
  *  - retrieve data from MMIO gpi core.
+ *  - poll() turns input changes into timestamped edge events
+ *  - optional software debouncing of all inputs (VertDebounce)
  *
  * MMIO subsystem HDL parameter:
  *  - W (not used in driver): # bits of input register
@@ -58,8 +162,61 @@ public:
     */
    int read(int bit_pos);
 
+   /**
+    * read the input and queue an event per changed bit
+    *
+    * @return # edges found
+    * @note edge time resolution is the poll interval; the first poll
+    *       compares against 0
+    */
+   int poll();
+
+   /**
+    * remove the oldest edge event
+    *
+    * @param ev pointer to the event
+    * @return 1: event returned; 0: none
+    */
+   int get_edge(GpiEdge *ev);
+
+   /**
+    * find the first edge at or after a time (event kept)
+    *
+    * @param t_us start time (now_us() value)
+    * @param mask bits of interest
+    * @param ev pointer to the event
+    * @return 1: found; 0: none
+    * @note call poll() first to pick up new changes
+    */
+   int first_edge_since(uint32_t t_us, uint32_t mask, GpiEdge *ev);
+
+   /**
+    * enable/disable software debouncing in poll()
+    *
+    * @param n # stable samples to accept a change (0: off; max
+    *        VertDebounce::MAX_SAMPLES)
+    * @param period_us sample interval; poll() calls in between are
+    *        ignored
+    *
+    * @note edges are reported (and stamped) n samples after the
+    *       input settles; the current input is taken as the state
+    *       of both the filter and the edge detector, so calling it
+    *       again re-seeds them (changes before the call give no edge)
+    */
+   void set_debounce(int n, uint32_t period_us);
+
+   /**
+    * software-debounced input (see set_debounce())
+    * @return 32-bit debounced word
+    */
+   uint32_t read_db();
+
 private:
    uint32_t base_addr;
+   GpiEdgeQueue edges;
+   VertDebounce db;
+   uint32_t db_period;   // 0: debouncing off
+   uint32_t db_last;     // time of the last sample (us)
 };
 
 
@@ -69,6 +226,9 @@ private:
 /**
  * gpo (general-purpose output) core driver
  *  - write data to MMIO gpo core.
+ *  - multi-bit updates (masked write, set/clear/toggle) in one write
+ *  - deferred mode: updates only change the shadow register;
+ *    flush() writes it once (e.g., once per display frame)
  *
  * MMIO subsystem HDL parameter:
  *  - W (not used in driver): # bits of output register
@@ -106,9 +266,67 @@ public:
     */
    void write(int bit_value, int bit_pos);
 
+   /**
+    * write the bits selected by a mask
+    *
+    * @param mask bits to change
+    * @param value new values (bits outside mask ignored)
+    *
+    */
+   void write_masked(uint32_t mask, uint32_t value);
+
+   /**
+    * set the bits of a mask to 1
+    *
+    * @param mask bits to set
+    *
+    */
+   void set_bits(uint32_t mask);
+
+   /**
+    * clear the bits of a mask to 0
+    *
+    * @param mask bits to clear
+    *
+    */
+   void clear_bits(uint32_t mask);
+
+   /**
+    * invert the bits of a mask
+    *
+    * @param mask bits to invert
+    *
+    */
+   void toggle_bits(uint32_t mask);
+
+   /**
+    * enable/disable deferred mode
+    *
+    * @param on 1: deferred; 0: immediate (pending change written)
+    *
+    */
+   void set_deferred(int on);
+
+   /**
+    * write the shadow register to the core if it changed
+    *
+    * @note no effect in immediate mode
+    */
+   void flush();
+
+   /**
+    * get the current (shadow) output value
+    *
+    * @return 32-bit output word, including unflushed changes
+    */
+   uint32_t read_shadow();
+
 private:
    uint32_t base_addr;
-   uint32_t wr_data;      // same as GPO core data reg
+   uint32_t wr_data;      // same as GPO core data reg (after flush())
+   uint32_t hw_data;      // last value written to the core
+   int deferred;
+   void commit();
 };
 
 
@@ -140,7 +358,8 @@ public:
     */
    enum {
       RESOLUTION_BITS = 10, /**< # resolution bits defined in HDL */
-      MAX = 1 << RESOLUTION_BITS /**< # max levels in duty cycle (= 2^ESOLUTION_BITS; 100% duty cycle) */
+      MAX = 1 << RESOLUTION_BITS, /**< # max levels in duty cycle (= 2^ESOLUTION_BITS; 100% duty cycle) */
+      RGB_LEDS = 2          /**< # tri-color leds (led n: channels 3n to 3n+2) */
    };
    /**
     * constructor.
@@ -178,9 +397,29 @@ public:
     */
    void set_duty(double f, int channel);
 
+   /**
+    * set the color of a tri-color led
+    *
+    * @param c color (8-bit r/g/b levels)
+    * @param led tri-color led number (channels 3 x led + 0/1/2 = r/g/b)
+    *
+    * @note levels are scaled by the white-balance gains and mapped
+    *       through the gamma table; integer only, three register writes
+    */
+   void set_color(PwmRgb c, int led);
+
+   /**
+    * set the white-balance gains of a tri-color led
+    *
+    * @param gain r/g/b gains (255: 1.0); default 255/255/255
+    * @param led tri-color led number
+    */
+   void set_white_balance(PwmRgb gain, int led);
+
 private:
    uint32_t base_addr;
    uint32_t freq;
+   PwmRgb wb[RGB_LEDS];
 };
 
 
@@ -245,8 +484,35 @@ public:
     * @return debounced 1-bit read data
     */
    int read_db(int bit_pos);
+
+   /**
+    * read the debounced input and queue an event per changed bit
+    *
+    * @return # edges found
+    * @note same as GpiCore::poll() on the debounced register
+    */
+   int poll();
+
+   /**
+    * remove the oldest debounced edge event
+    *
+    * @param ev pointer to the event
+    * @return 1: event returned; 0: none
+    */
+   int get_edge(GpiEdge *ev);
+
+   /**
+    * find the first debounced edge at or after a time (event kept)
+    *
+    * @param t_us start time (now_us() value)
+    * @param mask bits of interest
+    * @param ev pointer to the event
+    * @return 1: found; 0: none
+    */
+   int first_edge_since(uint32_t t_us, uint32_t mask, GpiEdge *ev);
 private:
    uint32_t base_addr;
+   GpiEdgeQueue edges;
 };
 
 
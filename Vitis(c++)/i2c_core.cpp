@@ -123,3 +123,60 @@ int I2cCore::write_transaction(uint8_t dev, uint8_t *bytes, int num,
    }
    return (ack);
 }
+
+#ifdef __cpp_impl_coroutine
+I2cOp I2cCore::start_async() {
+   return (I2cOp(this, I2C_START_CMD));
+}
+
+I2cOp I2cCore::restart_async() {
+   return (I2cOp(this, I2C_RESTART_CMD));
+}
+
+I2cOp I2cCore::stop_async() {
+   return (I2cOp(this, I2C_STOP_CMD));
+}
+
+I2cOp I2cCore::write_byte_async(uint8_t data) {
+   return (I2cOp(this, data | I2C_WR_CMD));
+}
+
+I2cOp I2cCore::read_byte_async(int last) {
+   return (I2cOp(this, last | I2C_RD_CMD));
+}
+
+I2cOp::I2cOp(I2cCore *core, uint32_t cmd_data) {
+   i2c = core;
+   acc_data = cmd_data;
+   result = 0;
+   state = 0;
+}
+
+/* issue command when ready; read/write also wait for the result */
+int I2cOp::poll() {
+   uint32_t cmd, rd_word;
+
+   cmd = acc_data & 0x0700;
+   if (state == 0) {
+      if (!i2c->ready())
+         return (0);
+      io_write(i2c->base_addr, I2cCore::WR_REG, acc_data);
+      state = (cmd == I2cCore::I2C_WR_CMD || cmd == I2cCore::I2C_RD_CMD) ? 1 : 2;
+   }
+   if (state == 1) {
+      rd_word = io_read(i2c->base_addr, I2cCore::RD_REG);
+      if (!((rd_word >> 8) & 0x01))
+         return (0);
+      if (cmd == I2cCore::I2C_WR_CMD)
+         result = (rd_word & 0x0200) ? -1 : 0;   // slave ack
+      else
+         result = (int) (rd_word & 0x00ff);
+      state = 2;
+   }
+   return (1);
+}
+
+int I2cOp::await_resume() {
+   return (result);
+}
+#endif  // __cpp_impl_coroutine
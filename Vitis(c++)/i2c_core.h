@@ -16,6 +16,28 @@
 #define _I2C_CORE_H_INCLUDED
 
 #include "chu_init.h"
+#include "async_io.h"
+
+#ifdef __cpp_impl_coroutine
+class I2cCore;
+
+/**
+ * awaitable i2c command (see I2cCore::*_async())
+ *  - co_await returns: ack status (0/-1) for write;
+ *    8-bit data for read; 0 for start/restart/stop
+ */
+class I2cOp: public AsyncOp {
+public:
+   I2cOp(I2cCore *core, uint32_t cmd_data);
+   int poll();
+   int await_resume();
+private:
+   I2cCore *i2c;
+   uint32_t acc_data;   // command and data written to wr_reg
+   int result;
+   int state;           // 0: wait to issue; 1: wait for completion; 2: done
+};
+#endif
 
 /**
  * i2c core driver
@@ -114,6 +136,23 @@ public:
     */
    int read_byte(int last);
 
+#ifdef __cpp_impl_coroutine
+   /**
+    * non-blocking versions of start()/restart()/stop()/
+    * write_byte()/read_byte() for an AsyncTask
+    *
+    * @return awaitable op; co_await yields the same value as
+    *         the blocking function (0 for start/restart/stop)
+    *
+    * @note usage: ack = co_await i2c.write_byte_async(dev_byte);
+    *
+    */
+   I2cOp start_async();
+   I2cOp restart_async();
+   I2cOp stop_async();
+   I2cOp write_byte_async(uint8_t data);
+   I2cOp read_byte_async(int last);
+#endif
 
    /**
     * perform a read transaction
@@ -149,6 +188,9 @@ public:
          int restart);
 
 private:
+#ifdef __cpp_impl_coroutine
+   friend class I2cOp;
+#endif
    /* variable to keep track of current status */
    uint32_t base_addr;
 
@@ -0,0 +1,121 @@
+/*****************************************************************//**
+ * @file led_bcm.cpp
+ *
+ * @brief implementation of the LED BCM engine
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "led_bcm.h"
+
+LedBcm::LedBcm(GpoCore *led_p) {
+   led = led_p;
+   bits = 1;
+   cur = 0;
+   running = 0;
+   mask = 0;
+   shown = 0;
+   lsb_tick = 0;
+   due = 0;
+   for (int i = 0; i < MAX_BITS; i++)
+      plane[i] = 0;
+   st_start = 0;                // set by start()
+   st_busy = 0;
+   st_cycles = 0;
+}
+
+LedBcm::~LedBcm() {
+}
+
+void LedBcm::start(int bits, uint32_t lsb_us, uint32_t mask) {
+   if (bits < 1)
+      bits = 1;
+   if (bits > MAX_BITS)
+      bits = MAX_BITS;
+   this->bits = bits;
+   this->mask = mask;
+   lsb_tick = (uint64_t) lsb_us * SYS_CLK_FREQ;
+   for (int i = 0; i < MAX_BITS; i++)
+      plane[i] = 0;
+   cur = bits - 1;              // first poll() starts plane 0
+   shown = 0;
+   led->clear_bits(mask);
+   running = 1;
+   due = now_tick();
+   clear_stats();
+}
+
+void LedBcm::stop() {
+   running = 0;
+   led->clear_bits(mask);
+}
+
+void LedBcm::set_level_mask(uint32_t leds, int level) {
+   int b;
+
+   if (level < 0)
+      level = 0;
+   if (level > (1 << bits) - 1)
+      level = (1 << bits) - 1;     // full on
+   leds = leds & mask;
+   for (b = 0; b < bits; b++) {
+      if ((level >> b) & 0x01)
+         plane[b] = plane[b] | leds;
+      else
+         plane[b] = plane[b] & ~leds;
+   }
+}
+
+void LedBcm::set_level(int led, int level) {
+   set_level_mask(bit(led), level);
+}
+
+int LedBcm::poll() {
+   uint64_t now, len;
+
+   if (!running)
+      return (0);
+   now = now_tick();
+   if ((int64_t) (now - due) < 0)
+      return (0);
+   cur++;
+   if (cur == bits) {
+      cur = 0;
+      st_cycles++;
+   }
+   if (plane[cur] != shown) {
+      shown = plane[cur];
+      led->write_masked(mask, shown);   // one mmio write
+   }
+   len = lsb_tick << cur;               // binary weighted
+   due = due + len;
+   if ((int64_t) (due - now) < 0)
+      due = now + len;                  // far behind: restart timing
+   st_busy = st_busy + (now_tick() - now);
+   return (1);
+}
+
+uint32_t LedBcm::refresh_hz() {
+   uint64_t el;
+
+   el = now_tick() - st_start;
+   if (el == 0)
+      return (0);
+   return ((uint32_t) ((uint64_t) st_cycles * SYS_CLK_FREQ * 1000000 / el));
+}
+
+uint32_t LedBcm::cpu_ppm() {
+   uint64_t el;
+
+   el = now_tick() - st_start;
+   if (el == 0)
+      return (0);
+   return ((uint32_t) (st_busy * 1000000 / el));
+}
+
+void LedBcm::clear_stats() {
+   st_start = now_tick();
+   st_busy = 0;
+   st_cycles = 0;
+}
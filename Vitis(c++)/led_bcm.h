@@ -0,0 +1,117 @@
+/*****************************************************************//**
+ * @file led_bcm.h
+ *
+ * @brief Binary-code-modulated (BCM) brightness for GpoCore LEDs
+ *
+ * Description:
+ *  - each LED gets 2^bits brightness levels (bits = 1 to 4)
+ *  - bit plane b holds bit b of every LED level and is shown for
+ *    2^b x lsb_us; one refresh cycle is (2^bits - 1) x lsb_us
+ *  - poll() from the main loop: one masked MMIO write per plane
+ *    change (skipped when two planes are equal)
+ *  - set_level() costs one word update per bit plane
+ *  - refresh rate and cpu share of the plane writes are measured
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _LED_BCM_H_INCLUDED
+#define _LED_BCM_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+
+/**
+ * software BCM engine for up to 32 GPO LEDs
+ *  - polling must be frequent compared with lsb_us; a late poll
+ *    stretches the current plane (brightness error, no flicker
+ *    unless polling stops)
+ */
+class LedBcm {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      MAX_BITS = 4   /**< max bit planes (16 levels) */
+   };
+
+   /**
+    * constructor
+    *
+    * @param led_p pointer to the led core
+    */
+   LedBcm(GpoCore *led_p);
+   ~LedBcm();  // not used
+
+   /**
+    * start modulation (all levels 0)
+    *
+    * @param bits # bit planes (1 to MAX_BITS)
+    * @param lsb_us display time of the least significant plane
+    * @param mask LEDs controlled
+    */
+   void start(int bits, uint32_t lsb_us, uint32_t mask);
+
+   /**
+    * stop modulation and turn the LEDs off
+    */
+   void stop();
+
+   /**
+    * set the brightness of one LED
+    *
+    * @param led LED position
+    * @param level 0 (off) to 2^bits - 1 (full on)
+    */
+   void set_level(int led, int level);
+
+   /**
+    * set the brightness of several LEDs
+    *
+    * @param leds LED mask
+    * @param level 0 (off) to 2^bits - 1 (full on)
+    */
+   void set_level_mask(uint32_t leds, int level);
+
+   /**
+    * show the next bit plane if the current one has expired
+    *
+    * @return 1: plane changed; 0: otherwise
+    */
+   int poll();
+
+   /**
+    * refresh cycles per second since start() or clear_stats()
+    */
+   uint32_t refresh_hz();
+
+   /**
+    * cpu time spent in plane changes, in millionths of elapsed time
+    *
+    * @note excludes the early-return polls (one timer read each)
+    */
+   uint32_t cpu_ppm();
+
+   /**
+    * restart the refresh and cpu measurement
+    */
+   void clear_stats();
+
+private:
+   GpoCore *led;
+   uint32_t plane[MAX_BITS];
+   int bits;
+   int cur;            // plane shown now
+   int running;
+   uint32_t mask;
+   uint32_t shown;     // last word written
+   uint64_t lsb_tick;
+   uint64_t due;       // end of the current plane (clock tick)
+   uint64_t st_start;  // statistics
+   uint64_t st_busy;
+   uint32_t st_cycles;
+};
+
+#endif  // _LED_BCM_H_INCLUDED
@@ -0,0 +1,128 @@
+/*****************************************************************//**
+ * @file led_seq.cpp
+ *
+ * @brief implementation of the LED animation sequencer
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "led_seq.h"
+
+enum {
+   SEQ_IDLE = 0,
+   SEQ_CHASE,
+   SEQ_BLINK,
+   SEQ_BAR,
+   SEQ_FRAMES
+};
+
+static uint64_t ms2tick(uint32_t ms) {
+   return ((uint64_t) ms * 1000 * SYS_CLK_FREQ);
+}
+
+// mask of leds 0 to n-1
+static uint32_t led_mask(int n) {
+   return ((n >= 32) ? 0xffffffff : (uint32_t) (bit(n) - 1));
+}
+
+LedSeq::LedSeq(GpoCore *led_p) {
+   led = led_p;
+   mode = SEQ_IDLE;
+   steps = 0;
+   step = 0;
+   reps = 0;
+   mask = 0;
+   step_tick = 0;
+   frames = 0;
+   due = 0;
+}
+
+LedSeq::~LedSeq() {
+}
+
+void LedSeq::start(int m, int n, uint32_t msk, uint32_t ms, int repeat) {
+   if (mode != SEQ_IDLE)
+      led->clear_bits(mask & ~msk);  // leds of the old pattern not reused
+   mode = m;
+   steps = n;
+   step = 0;
+   reps = repeat;
+   mask = msk;
+   step_tick = ms2tick(ms);
+   due = now_tick();
+   poll();                         // first frame now
+}
+
+void LedSeq::chase(int n, uint32_t step_ms, int repeat) {
+   start(SEQ_CHASE, n, led_mask(n), step_ms, repeat);
+}
+
+void LedSeq::blink(uint32_t mask, uint32_t half_ms, int repeat) {
+   start(SEQ_BLINK, 2, mask, half_ms, repeat);
+}
+
+void LedSeq::bar(int n, uint32_t step_ms, int repeat) {
+   start(SEQ_BAR, n + 1, led_mask(n), step_ms, repeat);
+}
+
+void LedSeq::play(const LedFrame *frames, int n_frames, uint32_t mask,
+      int repeat) {
+   this->frames = frames;
+   start(SEQ_FRAMES, n_frames, mask, 0, repeat);
+}
+
+void LedSeq::stop() {
+   if (mode == SEQ_IDLE)
+      return;
+   mode = SEQ_IDLE;
+   led->clear_bits(mask);
+}
+
+// LED word and duration (clock ticks) of step k
+uint32_t LedSeq::frame(int k, uint64_t *dur) {
+   *dur = step_tick;
+   switch (mode) {
+   case SEQ_CHASE:
+      return (bit(k));
+   case SEQ_BLINK:
+      return ((k == 0) ? mask : 0);
+   case SEQ_BAR:
+      return (led_mask(k));
+   default:   // SEQ_FRAMES
+      *dur = ms2tick(frames[k].ms);
+      return (frames[k].leds);
+   }
+}
+
+int LedSeq::poll() {
+   uint64_t now, dur;
+   uint32_t leds;
+
+   if (mode == SEQ_IDLE)
+      return (0);
+   now = now_tick();
+   if ((int64_t) (now - due) < 0)
+      return (1);
+   if (step == steps) {            // end of a pass
+      step = 0;
+      if (reps > 0) {
+         reps--;
+         if (reps == 0) {
+            stop();
+            return (0);
+         }
+      }
+   }
+   leds = frame(step, &dur);
+   led->write_masked(mask, leds);  // one mmio write
+   step++;
+   due = due + dur;
+   if ((int64_t) (due + dur - now) < 0)
+      due = now + dur;             // far behind: restart timing
+   return (1);
+}
+
+int LedSeq::busy() {
+   return (mode != SEQ_IDLE);
+}
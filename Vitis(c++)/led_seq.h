@@ -0,0 +1,120 @@
+/*****************************************************************//**
+ * @file led_seq.h
+ *
+ * @brief Non-blocking LED animation sequencer for a GpoCore
+ *
+ * Description:
+ *  - built-in patterns: chase, blink, bar graph
+ *  - custom patterns: const LedFrame tables (frame word + duration)
+ *  - poll() from the main loop; a frame is written when its deadline
+ *    (64-bit clock tick count) is reached: one MMIO write per step
+ *  - deadlines advance by the step length, so a late poll does not
+ *    stretch the animation
+ *  - only the LEDs of the pattern mask are changed (masked write)
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _LED_SEQ_H_INCLUDED
+#define _LED_SEQ_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+
+/**
+ * frame of a custom LED pattern
+ */
+struct LedFrame {
+   uint32_t leds;   /**< LED word of the frame */
+   uint32_t ms;     /**< frame duration in millisecond */
+};
+
+/**
+ * LED pattern player
+ *  - a new pattern replaces the one playing
+ *  - repeat: # passes of the pattern; 0 loops until stop()
+ *  - at the end the pattern LEDs are turned off
+ */
+class LedSeq {
+public:
+   /**
+    * constructor
+    *
+    * @param led_p pointer to the led core
+    */
+   LedSeq(GpoCore *led_p);
+   ~LedSeq();  // not used
+
+   /**
+    * one lit LED moving from LED 0 to LED n-1
+    *
+    * @param n # LEDs (1 to 32)
+    * @param step_ms time per LED
+    * @param repeat # passes (0: forever)
+    */
+   void chase(int n, uint32_t step_ms, int repeat);
+
+   /**
+    * LEDs of a mask on and off
+    *
+    * @param mask LEDs to blink
+    * @param half_ms on (and off) time
+    * @param repeat # on/off cycles (0: forever)
+    */
+   void blink(uint32_t mask, uint32_t half_ms, int repeat);
+
+   /**
+    * bar graph filling LED 0 to LED n-1, then empty
+    *
+    * @param n # LEDs (1 to 32)
+    * @param step_ms time per level
+    * @param repeat # passes (0: forever)
+    */
+   void bar(int n, uint32_t step_ms, int repeat);
+
+   /**
+    * custom frame list
+    *
+    * @param frames frame table (not copied; must stay valid)
+    * @param n_frames # frames
+    * @param mask LEDs controlled by the frames
+    * @param repeat # passes (0: forever)
+    */
+   void play(const LedFrame *frames, int n_frames, uint32_t mask, int repeat);
+
+   /**
+    * stop the pattern and turn its LEDs off
+    */
+   void stop();
+
+   /**
+    * write the next frame if its deadline has passed
+    *
+    * @return 1: pattern playing; 0: idle
+    * @note call at least once per step; never waits
+    */
+   int poll();
+
+   /**
+    * check whether a pattern is playing
+    *
+    * @return 1: playing; 0: idle
+    */
+   int busy();
+
+private:
+   GpoCore *led;
+   int mode;              // pattern type; 0: idle
+   int steps;             // # steps per pass
+   int step;              // next step
+   int reps;              // passes left (0: forever)
+   uint32_t mask;
+   uint64_t step_tick;    // built-in patterns
+   const LedFrame *frames;
+   uint64_t due;          // deadline of the next step (clock tick)
+   void start(int m, int n, uint32_t msk, uint32_t ms, int repeat);
+   uint32_t frame(int k, uint64_t *dur);
+};
+
+#endif  // _LED_SEQ_H_INCLUDED
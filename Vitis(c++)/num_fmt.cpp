@@ -0,0 +1,155 @@
+/*****************************************************************//**
+ * @file num_fmt.cpp
+ *
+ * @brief implementation of divide-free number formatting
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "num_fmt.h"
+
+// "00" "01" ... "99"
+static const char DIGIT2[201] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+static const char HEX_DIGIT[17] = "0123456789abcdef";
+
+// n / 100 for any 32-bit n: ceil(2^37/100) = 1374389535
+static inline uint32_t div100(uint32_t n) {
+   return ((uint32_t) (((uint64_t) n * 1374389535ULL) >> 37));
+}
+
+char *fmt_udec(char *end, uint32_t un) {
+   uint32_t q, r;
+
+   while (un >= 100) {
+      q = div100(un);
+      r = un - q * 100;
+      end = end - 2;
+      end[0] = DIGIT2[2 * r];
+      end[1] = DIGIT2[2 * r + 1];
+      un = q;
+   }
+   if (un >= 10) {
+      end = end - 2;
+      end[0] = DIGIT2[2 * un];
+      end[1] = DIGIT2[2 * un + 1];
+   } else {
+      end--;
+      *end = (char) un + '0';
+   }
+   return (end);
+}
+
+// base 2^shift
+static char *fmt_pow2(char *end, uint32_t un, int shift) {
+   uint32_t mask = (1UL << shift) - 1;
+
+   do {
+      end--;
+      *end = HEX_DIGIT[un & mask];
+      un = un >> shift;
+   } while (un);
+   return (end);
+}
+
+char *fmt_int(char *buf, int n, int base, int len) {
+   char *str, *end;
+
+   if (len > FMT_INT_SIZE - 1)
+      len = FMT_INT_SIZE - 1;
+   end = &buf[FMT_INT_SIZE - 1];
+   *end = '\0';
+   switch (base) {
+   case 2:
+      str = fmt_pow2(end, (uint32_t) n, 1);
+      break;
+   case 8:
+      str = fmt_pow2(end, (uint32_t) n, 3);
+      break;
+   case 16:
+      str = fmt_pow2(end, (uint32_t) n, 4);
+      break;
+   default:
+      if (n < 0) {
+         str = fmt_udec(end, 0 - (uint32_t) n);
+         str--;
+         *str = '-';
+      } else {
+         str = fmt_udec(end, (uint32_t) n);
+      }
+   }
+   /* pad with blank */
+   while (end - str < len) {
+      str--;
+      *str = ' ';
+   }
+   return (str);
+}
+
+// layout: integer part ends at buf[12], '.' at buf[12], fraction follows;
+// dot: print '.' even without fraction digits (legacy disp(double))
+static char *fmt_parts(char *buf, int neg, uint32_t ipart, uint32_t frac,
+      int frac_bits, int digit, int dot) {
+   char *str, *p;
+   uint32_t mask;
+   int i;
+
+   if (digit > FMT_MAX_FRAC)
+      digit = FMT_MAX_FRAC;
+   str = fmt_udec(&buf[12], ipart);
+   if (neg) {
+      str--;
+      *str = '-';
+   }
+   p = &buf[12];
+   if (digit > 0 || dot) {
+      *p = '.';
+      p++;
+   }
+   if (digit > 0) {
+      mask = (1UL << frac_bits) - 1;
+      for (i = 0; i < digit; i++) {
+         frac = (frac << 3) + (frac << 1);   // x10
+         *p = (char) (frac >> frac_bits) + '0';
+         frac = frac & mask;
+         p++;
+      }
+   }
+   *p = '\0';
+   return (str);
+}
+
+char *fmt_fixed(char *buf, int32_t q, int frac_bits, int digit) {
+   uint32_t uq;
+   int neg;
+
+   if (frac_bits > FMT_MAX_QBITS)
+      frac_bits = FMT_MAX_QBITS;
+   neg = (q < 0);
+   uq = neg ? 0 - (uint32_t) q : (uint32_t) q;
+   return (fmt_parts(buf, neg, uq >> frac_bits,
+         uq & ((1UL << frac_bits) - 1), frac_bits, digit, 0));
+}
+
+char *fmt_double(char *buf, double f, int digit) {
+   double fa;
+   uint32_t i_part, frac;
+   int neg;
+
+   neg = (f < 0.0);
+   fa = neg ? -f : f;
+   i_part = (uint32_t) fa;
+   // one float multiply; the digits come from integer ops
+   // round up by one lsb: 0.1, 0.7 etc. are a bit low in binary and
+   // would print one digit low after truncation
+   frac = (uint32_t) ((fa - (double) i_part) * (double) (1UL << FMT_MAX_QBITS)
+         + 1.0);
+   if (frac >> FMT_MAX_QBITS) {
+      i_part++;
+      frac = frac - (1UL << FMT_MAX_QBITS);
+   }
+   return (fmt_parts(buf, neg, i_part, frac, FMT_MAX_QBITS, digit, 1));
+}
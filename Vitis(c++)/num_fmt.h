@@ -0,0 +1,86 @@
+/*****************************************************************//**
+ * @file num_fmt.h
+ *
+ * @brief Divide-free number-to-string conversion
+ *
+ * Description:
+ *  - decimal: two digits per step from a 200-char table;
+ *    /100 done by reciprocal multiply (exact for 32-bit values)
+ *  - binary/octal/hex: shift and mask
+ *  - fixed point: Q-format value (frac_bits fraction bits);
+ *    each fraction digit is a x10 (shift/add), shift and mask
+ *  - strings are built backward from the end of a caller buffer;
+ *    the returned pointer is the first char (no heap, no copy)
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _NUM_FMT_H_INCLUDED
+#define _NUM_FMT_H_INCLUDED
+
+#include "chu_io_rw.h"
+
+/**
+ * buffer sizes (including the terminating '\0')
+ */
+enum {
+   FMT_INT_SIZE = 33,    /**< 32 binary digits or 32-char padding */
+   FMT_FIXED_SIZE = 32,  /**< sign, 10 int digits, '.', FMT_MAX_FRAC */
+   FMT_MAX_FRAC = 18,    /**< max # fraction digits */
+   FMT_MAX_QBITS = 28    /**< max # fraction bits of a Q-format value */
+};
+
+/**
+ * convert an integer to a string
+ *
+ * @param buf buffer of FMT_INT_SIZE chars
+ * @param n integer
+ * @param base 2/8/10/16 (other values treated as 10)
+ * @param len minimal # chars; blanks padded on the left (max 32)
+ * @return pointer to the string inside buf
+ *
+ * @note same format as UartCore::disp(int, int, int); negative values
+ *       get a '-' sign in base 10 only
+ */
+char *fmt_int(char *buf, int n, int base, int len);
+
+/**
+ * convert an unsigned integer to a decimal string
+ *
+ * @param end pointer one past the last digit
+ * @param un value
+ * @return pointer to the first digit (string is not terminated)
+ */
+char *fmt_udec(char *end, uint32_t un);
+
+/**
+ * convert a Q-format fixed-point number to a decimal string
+ *
+ * @param buf buffer of FMT_FIXED_SIZE chars
+ * @param q fixed-point value (value = q / 2^frac_bits)
+ * @param frac_bits # fraction bits (0 to FMT_MAX_QBITS)
+ * @param digit # fraction digits (truncated, max FMT_MAX_FRAC)
+ * @return pointer to the string inside buf
+ *
+ * @note e.g., q=0x1a80, frac_bits=8, digit=2 gives "26.50"
+ */
+char *fmt_fixed(char *buf, int32_t q, int frac_bits, int digit);
+
+/**
+ * convert a floating-point number to a decimal string
+ *
+ * @param buf buffer of FMT_FIXED_SIZE chars
+ * @param f number (|f| < 2^31)
+ * @param digit # fraction digits (truncated, max FMT_MAX_FRAC)
+ * @return pointer to the string inside buf
+ *
+ * @note the fraction is converted once to Q28 (rounded up by one lsb)
+ *       and printed as fixed point; digits beyond ~8 carry no
+ *       information
+ * @note same format as UartCore::disp(double, int): '.' is printed
+ *       even if digit is 0
+ */
+char *fmt_double(char *buf, double f, int digit);
+
+#endif  // _NUM_FMT_H_INCLUDED
@@ -12,6 +12,38 @@
 
 Ps2Core::Ps2Core(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   kb_ext = 0;
+   kb_brk = 0;
+   kb_pause = 0;
+   kb_shift = 0;
+   kb_head = 0;
+   kb_tail = 0;
+   kb_drop = 0;
+   for (int i = 0; i < 8; i++)
+      kb_down[i] = 0;
+   kb_mole = 0;
+   kb_mole_hit = 0;
+   for (int i = 0; i < MOLE_KEYS; i++)
+      kb_mole_us[i] = 0;
+   ms_cnt = 0;
+   ms_btn = 0;
+   ms_dx = 0;
+   ms_dy = 0;
+   ms_pkts = 0;
+   ms_hold = 0;
+   ms_resync = 0;
+   init_state = 0;
+   init_res = -1;
+   init_t0 = 0;
+   init_t = 0;
+   init_tmo = 0;
+   init_lat = 0;
+   cmd_head = 0;
+   cmd_tail = 0;
+   cmd_wait = 0;
+   cmd_retry = 0;
+   cmd_t = 0;
+   cmd_fail = 0;
 }
 
 Ps2Core::~Ps2Core() {
@@ -60,62 +92,179 @@ int Ps2Core::rx_byte() {
  *    5b. mouse sends an extra id 0x00
  *    6. host sends 0xf4 to start stream mode
  *    7. mouse acknowledges (0xfa)
+ * steps 3-7 are run by init_poll(); each waits only until its byte
+ * arrives or its timeout expires
  */
+enum {
+   INIT_ST_DONE = 0,
+   INIT_ST_ACK,      // wait 0xfa of reset
+   INIT_ST_BAT,      // wait 0xaa (self test passed)
+   INIT_ST_ID,       // wait mouse id 0x00; none means keyboard
+   INIT_ST_STREAM    // wait 0xfa of stream mode command
+};
+
 int Ps2Core::init() {
-   int packet;
+   int id;
+
+   init_start();
+   do {
+      id = init_poll();
+   } while (id == INIT_BUSY);
+   return (id);
+}
 
+void Ps2Core::init_start() {
    /* flush fifo buffer */
    while (!rx_fifo_empty()) {
       rx_byte();
    }
+   kb_ext = 0;
+   kb_brk = 0;
+   kb_pause = 0;
+   ms_cnt = 0;
+   cmd_tail = cmd_head;    // reset clears pending commands
+   cmd_wait = 0;
    /* send reset 0xff  */
-   debug("ps2 reset: write command ", 0, 0);
+   log_dbg(LOG_MOD_PS2, "ps2 reset: write command ", 0, 0);
    tx_byte(0xff);
-   sleep_ms(2000);    // 200 ms not long enough for USB keyboard
-   /* check 0xfa 0xaa */
-   if (rx_byte() != 0xfa) {
-      return (-1);        // no response or wrong response
-   }
-   if (rx_byte() != 0xaa) {
-      return (-1);        // no response or wrong response
-   }
-   debug("ps2 reset: 0xfa 0xaa valid ", 0, 0);
-   /* check whether 0x00 is received */
-   packet = rx_byte();
-   if (packet == -1) {
-      return (1);        // fifo has no more packet, device is keyboard
-   }
-   if (packet != 0x00) {
-      return (-2); // unknown ps2 device (unlikely)
-   }
-   /* device is a mouse; set it to stream mode */
-   tx_byte(0xf4);
-   sleep_ms(100);
-   /* check 0xfa (acknowledge) */
-   if (rx_byte() != 0xfa) {
-      return (-3);        // no response or wrong response
+   init_t0 = (uint32_t) now_us();
+   init_t = init_t0;
+   init_tmo = INIT_RESET_MS * 1000UL;  // 200 ms not long enough for USB keyboard
+   init_lat = 0;
+   init_state = INIT_ST_ACK;
+}
+
+void Ps2Core::init_end(int res) {
+   init_res = res;
+   init_state = INIT_ST_DONE;
+}
+
+int Ps2Core::init_poll() {
+   uint32_t now;
+   int packet;
+
+   while (init_state != INIT_ST_DONE) {
+      now = (uint32_t) now_us();
+      packet = rx_byte();
+      if (packet == -1) {
+         if (now - init_t < init_tmo)
+            break;                  // keep waiting
+         if (init_state == INIT_ST_ID)
+            init_end(1);            // no id byte, device is keyboard
+         else if (init_state == INIT_ST_STREAM)
+            init_end(-3);           // no acknowledge
+         else
+            init_end(-1);           // no response
+         break;
+      }
+      switch (init_state) {
+      case INIT_ST_ACK:
+         if (packet != 0xfa)
+            init_end(-1);           // wrong response
+         else
+            init_state = INIT_ST_BAT;
+         break;
+      case INIT_ST_BAT:
+         if (packet != 0xaa) {
+            init_end(-1);           // wrong response
+            break;
+         }
+         init_lat = now - init_t0;
+         log_dbg(LOG_MOD_PS2, "ps2 reset: 0xfa 0xaa valid, latency (us) ",
+               (int) init_lat, 0);
+         init_state = INIT_ST_ID;
+         init_t = now;
+         init_tmo = INIT_ID_MS * 1000UL;
+         break;
+      case INIT_ST_ID:
+         if (packet != 0x00) {
+            init_end(-2);           // unknown ps2 device (unlikely)
+            break;
+         }
+         /* device is a mouse; set it to stream mode */
+         tx_byte(0xf4);
+         init_state = INIT_ST_STREAM;
+         init_t = now;
+         init_tmo = INIT_ACK_MS * 1000UL;
+         break;
+      default:                      // INIT_ST_STREAM
+         init_end((packet == 0xfa) ? 2 : -3);
+      }
    }
-   return (2);  //success
+   return ((init_state == INIT_ST_DONE) ? init_res : (int) INIT_BUSY);
+}
+
+uint32_t Ps2Core::init_latency_us() {
+   return (init_lat);
 }
 
 int Ps2Core::get_mouse_activity(int *lbtn, int *rbtn, int *xmov,
       int *ymov) {
-   uint8_t b1, b2, b3;
+   poll_mouse();
+   if (ms_pkts == 0)
+      return (0);                         // no complete packet
+   *lbtn = ms_btn & 0x01;
+   *rbtn = (ms_btn & 0x02) >> 1;
+   *xmov = ms_dx;
+   *ymov = ms_dy;
+   ms_dx = 0;
+   ms_dy = 0;
+   ms_pkts = 0;
+   ms_hold = 0;
+   return (1);
+}
+
+/*
+ * packet: header (bit 3 always 1), x, y
+ *  - header bits: 0/1/2 buttons, 4/5 x/y sign, 6/7 x/y overflow
+ */
+int Ps2Core::ms_decode(uint8_t byte) {
+   int lbtn, rbtn, x, y, btn;
+
+   if (ms_cnt == 0 && !(byte & 0x08)) {
+      ms_resync++;       // not a header; drop until aligned
+      return (0);
+   }
+   ms_b[ms_cnt] = byte;
+   ms_cnt++;
+   if (ms_cnt < 3)
+      return (0);
+   ms_cnt = 0;
+   decode_mouse(ms_b[0], ms_b[1], ms_b[2], &lbtn, &rbtn, &x, &y);
+   btn = ms_b[0] & 0x07;
+   if (btn != ms_btn)
+      ms_hold = 1;       // report the change before decoding on
+   ms_btn = btn;
+   ms_dx = ms_dx + x;
+   ms_dy = ms_dy + y;
+   ms_pkts++;
+   return (1);
+}
 
+int Ps2Core::poll_mouse() {
+   uint32_t rd_word;
+   int n;
+
+   n = 0;
+   while (!ms_hold) {
+      // empty flag and data from one read
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      if (rd_word & RX_EMPT_FIELD)
+         break;
+      io_write(base_addr, RM_RD_DATA_REG, 0); //dummy write to remove data from rx FIFO
+      n = n + ms_decode((uint8_t) (rd_word & RX_DATA_FIELD));
+   }
+   return (n);
+}
+
+uint32_t Ps2Core::mouse_resyncs() {
+   return (ms_resync);
+}
+
+void Ps2Core::decode_mouse(uint8_t b1, uint8_t b2, uint8_t b3, int *lbtn,
+      int *rbtn, int *xmov, int *ymov) {
    uint32_t tmp;
 
-   /* check and retrieve 1st byte */
-   if (rx_fifo_empty())
-      return (0);                         // no data in rx fifo buffer
-   b1 = rx_byte();
-   /* wait and retrieve 2nd byte */
-   while (rx_fifo_empty())
-      ;
-   b2 = rx_byte();
-   /* wait and retrieve 3rd byte */
-   while (rx_fifo_empty())
-      ;
-   b3 = rx_byte();
    /* extract button info */
    *lbtn = (int) (b1 & 0x01);      // extract bit 0
    *rbtn = (int) (b1 & 0x02) >> 1; // extract bit 1
@@ -123,18 +272,19 @@ int Ps2Core::get_mouse_activity(int *lbtn, int *rbtn, int *xmov,
    tmp = (uint32_t) b2;
    if (b1 & 0x10)                // check MSB (sign bit) of x movement
       tmp = tmp | 0xffffff00;    // manual sign-extension if negative
+   if (b1 & 0x40)                // overflow: saturate in sign direction
+      tmp = (b1 & 0x10) ? 0xffffff00 : 0x000000ff;
    *xmov = (int) tmp;            // data conversion
    /* extract y movement; manually convert 9-bit 2's comp to int */
    tmp = (uint32_t) b3;
    if (b1 & 0x20)                // check MSB (sign bit) of y movement
       tmp = tmp | 0xffffff00;     // manual sign-extension if negative
+   if (b1 & 0x80)                // overflow: saturate in sign direction
+      tmp = (b1 & 0x20) ? 0xffffff00 : 0x000000ff;
    *ymov = (int) tmp;            // data conversion
-   /* success */
-   return (1);
 }
 
-int Ps2Core::get_kb_ch(char *ch) {
-   // special  characters
+/* special characters */
 #define TAB     0x09   // tab
 #define BKSP    0x08   // backspace
 #define ENTER   0x0d   // enter (new line)
@@ -159,71 +309,338 @@ int Ps2Core::get_kb_ch(char *ch) {
 #define F11     0xfa
 #define F12     0xfb
 
-   // keyboard scan code to ascii (lowercase)
-   static const uint8_t SCAN2ASCII_LO_TABLE[128] = {
-         0, F9, 0, F5, F3, F1,   F2, F12,        //00
-         0, F10, F8, F6, F4, TAB, '`', 0,        //08
-         0, 0, SFT_L, 0, CTR_L, 'q', '1', 0,     //10
-         0, 0, 'z', 's', 'a', 'w', '2', 0,       //18
-         0, 'c', 'x', 'd', 'e', '4', '3', 0,     //20
-         0, ' ', 'v', 'f', 't', 'r', '5', 0,     //28
-         0, 'n', 'b', 'h', 'g', 'y', '6', 0,     //30
-         0, 0, 'm', 'j', 'u', '7', '8', 0,       //38
-         0, ',', 'k', 'i', 'o', '0', '9', 0,     //40
-         0, '.', '/', 'l', ';', 'p', '-', 0,     //48
-         0, 0, '\'', 0, '[', '=', 0, 0,          //50
-         CAPS, SFT_R, ENTER, ']', 0, BKSL, 0, 0, //58
-         0, 0, 0, 0, 0, 0, BKSP, 0,              //60
-         0, '1', 0, '4', '7', 0, 0, 0,           //68
-         0, '.', '2', '5', '6', '8', ESC, NUM,   //70
-         F11, '+', '3', '-', '*', '9', 0, 0      //78
-         };
-   // keyboard scan code to ascii (uppercase)
-   static const uint8_t SCAN2ASCII_UP_TABLE[128] = {
-         0, F9, 0, F5, F3, F1, F2, F12,         //00
-         0, F10, F8, F6, F4, TAB, '~', 0,       //08
-         0, 0, SFT_L, 0, CTR_L, 'Q', '!', 0,    //10
-         0, 0, 'Z', 'S', 'A', 'W', '@', 0,      //18
-         0, 'C', 'X', 'D', 'E', '$', '#', 0,    //20
-         0, ' ', 'V', 'F', 'T', 'R', '%', 0,    //28
-         0, 'N', 'B', 'H', 'G', 'Y', '^', 0,    //30
-         0, 0, 'M', 'J', 'U', '&', '*', 0,      //38
-         0, '<', 'K', 'I', 'O', ')', '(', 0,    //40
-         0, '>', '?', 'L', ':', 'P', '_', 0,    //48
-         0, 0, '\"', 0, '{', '+', 0, 0,         //50
-         CAPS, SFT_R, ENTER, '}', 0, '|', 0, 0, //58
-         0, 0, 0, 0, 0, 0, BKSP, 0,             //60
-         0, '1', 0, '4', '7', 0, 0, 0,          //68
-         0, '.', '2', '5', '6', '8', ESC, NUM,  //70
-         F11, '+', '3', '-', '*', '9', 0, 0     //78
-         };
-
-   static int sft_on = 0;
-   uint8_t scode;
+// keyboard scan code to ascii (lowercase)
+static const uint8_t SCAN2ASCII_LO_TABLE[128] = {
+      0, F9, 0, F5, F3, F1,   F2, F12,        //00
+      0, F10, F8, F6, F4, TAB, '`', 0,        //08
+      0, 0, SFT_L, 0, CTR_L, 'q', '1', 0,     //10
+      0, 0, 'z', 's', 'a', 'w', '2', 0,       //18
+      0, 'c', 'x', 'd', 'e', '4', '3', 0,     //20
+      0, ' ', 'v', 'f', 't', 'r', '5', 0,     //28
+      0, 'n', 'b', 'h', 'g', 'y', '6', 0,     //30
+      0, 0, 'm', 'j', 'u', '7', '8', 0,       //38
+      0, ',', 'k', 'i', 'o', '0', '9', 0,     //40
+      0, '.', '/', 'l', ';', 'p', '-', 0,     //48
+      0, 0, '\'', 0, '[', '=', 0, 0,          //50
+      CAPS, SFT_R, ENTER, ']', 0, BKSL, 0, 0, //58
+      0, 0, 0, 0, 0, 0, BKSP, 0,              //60
+      0, '1', 0, '4', '7', 0, 0, 0,           //68
+      0, '.', '2', '5', '6', '8', ESC, NUM,   //70
+      F11, '+', '3', '-', '*', '9', 0, 0      //78
+      };
+// keyboard scan code to ascii (uppercase)
+static const uint8_t SCAN2ASCII_UP_TABLE[128] = {
+      0, F9, 0, F5, F3, F1, F2, F12,         //00
+      0, F10, F8, F6, F4, TAB, '~', 0,       //08
+      0, 0, SFT_L, 0, CTR_L, 'Q', '!', 0,    //10
+      0, 0, 'Z', 'S', 'A', 'W', '@', 0,      //18
+      0, 'C', 'X', 'D', 'E', '$', '#', 0,    //20
+      0, ' ', 'V', 'F', 'T', 'R', '%', 0,    //28
+      0, 'N', 'B', 'H', 'G', 'Y', '^', 0,    //30
+      0, 0, 'M', 'J', 'U', '&', '*', 0,      //38
+      0, '<', 'K', 'I', 'O', ')', '(', 0,    //40
+      0, '>', '?', 'L', ':', 'P', '_', 0,    //48
+      0, 0, '\"', 0, '{', '+', 0, 0,         //50
+      CAPS, SFT_R, ENTER, '}', 0, '|', 0, 0, //58
+      0, 0, 0, 0, 0, 0, BKSP, 0,             //60
+      0, '1', 0, '4', '7', 0, 0, 0,          //68
+      0, '.', '2', '5', '6', '8', ESC, NUM,  //70
+      F11, '+', '3', '-', '*', '9', 0, 0     //78
+      };
+
+// Pause make code; the key sends no break code
+static const uint8_t PAUSE_SEQ[8] = {
+      0xe1, 0x14, 0x77, 0xe1, 0xf0, 0x14, 0xf0, 0x77 };
+
+/*
+ * feed one byte to the scan-code state machine
+ *  - 0xe0/0xf0 prefixes only set flags; the code byte completes an event
+ *  - 0xe1 starts the Pause sequence; its bytes are matched against
+ *    PAUSE_SEQ without touching the key map, and a mismatch falls
+ *    back to normal decoding of that byte
+ *  - device responses (0xfa ack etc.) are ignored
+ *  - key map index: code, or 0x80 | code for an extended key; normal
+ *    codes stop at 0x83 and no extended code is below 0x04, so the
+ *    two ranges do not overlap
+ */
+int Ps2Core::kb_decode(uint8_t byte, uint32_t time_us) {
+   int flags, sft, key, n;
+   uint32_t bit;
+   uint16_t m;
+
+   if (kb_pause > 0) {
+      if (byte == PAUSE_SEQ[kb_pause]) {
+         kb_pause++;
+         if (kb_pause < (int) sizeof(PAUSE_SEQ))
+            return (0);
+         kb_pause = 0;
+         return (kb_put(byte, KEY_PAUSE | (kb_shift ? KEY_SHIFT : 0),
+               time_us));
+      }
+      kb_pause = 0;      // broken sequence
+   }
+   if (byte == 0xe1) {
+      kb_pause = 1;
+      kb_ext = 0;
+      kb_brk = 0;
+      return (0);
+   }
+   if (byte == 0xe0) {
+      kb_ext = 1;
+      return (0);
+   }
+   if (byte == 0xf0) {
+      kb_brk = 1;
+      return (0);
+   }
+   if (byte >= 0x84 || byte == 0x00) {
+      kb_ext = 0;        // response or error; restart
+      kb_brk = 0;
+      return (0);
+   }
+   flags = (kb_brk ? KEY_BREAK : 0) | (kb_ext ? KEY_EXT : 0);
+   // track shift state before the event so a shift press reports itself
+   if (!kb_ext && (byte == SFT_L || byte == SFT_R)) {
+      sft = (byte == SFT_L) ? 0x01 : 0x02;
+      kb_shift = kb_brk ? (kb_shift & ~sft) : (kb_shift | sft);
+   }
+   if (kb_shift)
+      flags = flags | KEY_SHIFT;
+   /* key map and mole mask */
+   key = kb_ext ? (KEY_EXT_CODE | byte) : byte;
+   bit = 1UL << (key & 0x1f);
+   if (kb_brk)
+      kb_down[key >> 5] &= ~bit;
+   else
+      kb_down[key >> 5] |= bit;
+   n = (kb_ext || byte >= 0x80) ? 0 : SCAN2ASCII_LO_TABLE[byte] - 'a';
+   if (n >= 0 && n < MOLE_KEYS) {
+      m = (uint16_t) (1 << n);
+      if (kb_brk) {
+         kb_mole &= ~m;
+      } else if (!(kb_mole & m)) {     // not a typematic repeat
+         kb_mole |= m;
+         kb_mole_hit |= m;
+         kb_mole_us[n] = time_us;
+      }
+   }
+   kb_ext = 0;
+   kb_brk = 0;
+   return (kb_put(byte, flags, time_us));
+}
+
+/* append a key event; return 0 if the queue is full */
+int Ps2Core::kb_put(uint8_t code, int flags, uint32_t time_us) {
+   Ps2KeyEvent *ev;
+
+   if ((uint8_t) (kb_head - kb_tail) == KEY_QUEUE_SIZE) {
+      kb_drop++;
+      return (0);
+   }
+   ev = &kb_q[kb_head & (KEY_QUEUE_SIZE - 1)];
+   ev->time_us = time_us;
+   ev->code = code;
+   ev->flags = (uint8_t) flags;
+   if ((flags & (KEY_EXT | KEY_PAUSE)) || (code & 0x80))
+      ev->ch = 0;
+   else if (flags & KEY_SHIFT)
+      ev->ch = (char) SCAN2ASCII_UP_TABLE[code & 0x7f];
+   else
+      ev->ch = (char) SCAN2ASCII_LO_TABLE[code & 0x7f];
+   kb_head++;
+   return (1);
+}
+
+int Ps2Core::poll_kb() {
+   uint32_t rd_word, now;
+   uint8_t byte;
+   int n, stamped;
 
+   n = 0;
+   stamped = 0;
+   now = 0;
    while (1) {
-      if (rx_fifo_empty())         // no packet
-         return (0);
-      scode = rx_byte();
-      switch (scode) {
-      case 0xf0:                 // break code
-         while (rx_fifo_empty())
-            ; // get next
-         scode = rx_byte();
-         if (scode == SFT_L || scode == SFT_R)
-            sft_on = 0;
+      // empty flag and data from one read
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      if (rd_word & RX_EMPT_FIELD)
          break;
-      case SFT_L:                 // shift key make code
-      case SFT_R:
-         sft_on = 1;
-         break;
-      default:                    // normal make code
-         if (sft_on)
-            *ch = SCAN2ASCII_UP_TABLE[scode];
-         else
-            *ch = SCAN2ASCII_LO_TABLE[scode];
-         return (1);
-      }  // end switch
-   }  // end while
+      io_write(base_addr, RM_RD_DATA_REG, 0); //dummy write to remove data from rx FIFO
+      if (!stamped) {
+         now = (uint32_t) now_us();   // one time stamp per poll
+         stamped = 1;
+      }
+      byte = (uint8_t) (rd_word & RX_DATA_FIELD);
+      // no scan code is 0xfa/0xfe; route replies to the command queue
+      if (cmd_wait && (byte == 0xfa || byte == 0xfe))
+         cmd_reply(byte);
+      else
+         n = n + kb_decode(byte, now);
+   }
+   if (cmd_head != cmd_tail) {
+      if (!stamped)
+         now = (uint32_t) now_us();
+      cmd_pump(now);
+   }
+   return (n);
+}
+
+/* queue commands; arg < 0: no argument byte */
+int Ps2Core::cmd_put(uint8_t cmd, int arg) {
+   int len;
+
+   len = (arg < 0) ? 1 : 2;
+   if ((uint8_t) (cmd_head - cmd_tail) > CMD_QUEUE_SIZE - len)
+      return (-1);
+   if (arg < 0) {
+      cmd_q[cmd_head & (CMD_QUEUE_SIZE - 1)] = 0x100 | cmd;
+   } else {
+      cmd_q[cmd_head & (CMD_QUEUE_SIZE - 1)] = cmd;
+      cmd_head++;
+      cmd_q[cmd_head & (CMD_QUEUE_SIZE - 1)] = 0x100 | (uint8_t) arg;
+   }
+   cmd_head++;
+   cmd_pump((uint32_t) now_us());       // start now if the line is free
+   return (0);
+}
+
+int Ps2Core::send_cmd(uint8_t cmd, uint8_t arg) {
+   return (cmd_put(cmd, arg));
+}
+
+int Ps2Core::send_cmd(uint8_t cmd) {
+   return (cmd_put(cmd, -1));
+}
+
+int Ps2Core::set_typematic(int rate, int delay) {
+   return (cmd_put(0xf3, ((delay & 0x03) << 5) | (rate & 0x1f)));
+}
+
+int Ps2Core::set_kb_leds(int leds) {
+   return (cmd_put(0xed, leds & 0x07));
+}
+
+int Ps2Core::set_scan_set(int set) {
+   if (set < 1 || set > 3)
+      return (-2);
+   return (cmd_put(0xf0, set));
+}
+
+int Ps2Core::cmd_pending() {
+   return ((int) (uint8_t) (cmd_head - cmd_tail));
+}
+
+uint32_t Ps2Core::cmd_failed() {
+   return (cmd_fail);
+}
+
+/* send the byte at the queue tail or check its reply timeout */
+void Ps2Core::cmd_pump(uint32_t now) {
+   if (cmd_wait) {
+      if (now - cmd_t < CMD_ACK_MS * 1000UL)
+         return;
+      cmd_retry_or_drop();       // no reply
+   }
+   if (cmd_head == cmd_tail || !tx_idle())
+      return;
+   tx_byte((uint8_t) cmd_q[cmd_tail & (CMD_QUEUE_SIZE - 1)]);
+   cmd_wait = 1;
+   cmd_t = now;
+}
+
+void Ps2Core::cmd_reply(uint8_t byte) {
+   cmd_wait = 0;
+   if (byte == 0xfe) {
+      cmd_retry_or_drop();       // resend request
+      return;
+   }
+   cmd_tail++;                   // 0xfa: byte accepted
+   cmd_retry = 0;
+}
+
+/* resend the byte (by the next pump) or drop its whole command */
+void Ps2Core::cmd_retry_or_drop() {
+   uint16_t e;
+   int cmd;
+
+   cmd_wait = 0;
+   cmd_retry++;
+   if (cmd_retry <= CMD_RETRIES)
+      return;
+   cmd = cmd_q[cmd_tail & (CMD_QUEUE_SIZE - 1)] & 0xff;
+   do {
+      e = cmd_q[cmd_tail & (CMD_QUEUE_SIZE - 1)];
+      cmd_tail++;
+   } while (!(e & 0x100) && cmd_tail != cmd_head);
+   cmd_retry = 0;
+   cmd_fail++;
+   log_warn(LOG_MOD_PS2, "ps2 command dropped: ", cmd, 0);
 }
 
+int Ps2Core::get_key_event(Ps2KeyEvent *ev) {
+   poll_kb();
+   if (kb_tail == kb_head)
+      return (0);
+   *ev = kb_q[kb_tail & (KEY_QUEUE_SIZE - 1)];
+   kb_tail++;
+   return (1);
+}
+
+uint32_t Ps2Core::kb_dropped() {
+   return (kb_drop);
+}
+
+int Ps2Core::is_down(int key) {
+   key = key & 0xff;
+   return ((int) (kb_down[key >> 5] >> (key & 0x1f)) & 0x01);
+}
+
+uint16_t Ps2Core::mole_keys() {
+   return (kb_mole);
+}
+
+uint16_t Ps2Core::mole_presses() {
+   uint16_t m;
+
+   m = kb_mole_hit;
+   kb_mole_hit = 0;
+   return (m);
+}
+
+uint32_t Ps2Core::mole_press_us(int n) {
+   return (kb_mole_us[n & (MOLE_KEYS - 1)]);
+}
+
+int Ps2Core::get_kb_ch(char *ch) {
+   Ps2KeyEvent ev;
+
+   while (get_key_event(&ev)) {
+      if (ev.flags & (KEY_BREAK | KEY_EXT | KEY_PAUSE))
+         continue;
+      if (ev.code == SFT_L || ev.code == SFT_R)
+         continue;
+      *ch = ev.ch;
+      return (1);
+   }
+   return (0);
+}
+
+#ifdef __cpp_impl_coroutine
+Ps2MouseOp Ps2Core::get_mouse_activity_async(int *lbtn, int *rbtn,
+      int *xmov, int *ymov) {
+   return (Ps2MouseOp(this, lbtn, rbtn, xmov, ymov));
+}
+
+Ps2MouseOp::Ps2MouseOp(Ps2Core *core, int *lbtn, int *rbtn, int *xmov,
+      int *ymov) {
+   ps2 = core;
+   this->lbtn = lbtn;
+   this->rbtn = rbtn;
+   this->xmov = xmov;
+   this->ymov = ymov;
+}
+
+/* the core keeps partial packets between polls */
+int Ps2MouseOp::poll() {
+   return (ps2->get_mouse_activity(lbtn, rbtn, xmov, ymov));
+}
+#endif  // __cpp_impl_coroutine
@@ -12,16 +12,54 @@
 #define _PS2_H_INCLUDED
 
 #include "chu_init.h"
+#include "async_io.h"
+
+#ifdef __cpp_impl_coroutine
+class Ps2Core;
+
+/**
+ * awaitable mouse packet (see Ps2Core::get_mouse_activity_async())
+ */
+class Ps2MouseOp: public AsyncOp {
+public:
+   Ps2MouseOp(Ps2Core *core, int *lbtn, int *rbtn, int *xmov, int *ymov);
+   int poll();
+   void await_resume() {
+   }
+private:
+   Ps2Core *ps2;
+   int *lbtn, *rbtn, *xmov, *ymov;
+};
+#endif
 
 /**
  * ps2 core driver
  *  - transmit/receive raw byte stream to/from MMIO timer core.
  *  - initialize ps2 mouse
- *  - get mouse movement/button activities
+ *  - get mouse movement/button activities; packets are decoded one
+ *    byte at a time, realigned on a bad header byte and coalesced
  *  - get keyboard char
+ *  - decode keyboard scan codes one byte at a time into a queue of
+ *    timestamped key events (never waits for the next byte); the
+ *    8-byte 0xe1 Pause sequence yields a single KEY_PAUSE event
+ *  - keep a 256-bit pressed-key map and a 16-bit mask of the
+ *    "mole" keys a-p for multi-key (chord) input
+ *  - queue keyboard commands (typematic rate, LEDs, scan set); each
+ *    byte is sent when the transmitter is idle and retried on 0xfe
+ *    or timeout, interleaved with scan-code reception
  *
  */
 
+/**
+ * keyboard event
+ */
+struct Ps2KeyEvent {
+   uint32_t time_us;  /**< now_us() of the poll that completed the code */
+   uint8_t code;      /**< scan code (set 2) without prefixes */
+   uint8_t flags;     /**< Ps2Core::KEY_BREAK / KEY_EXT / KEY_SHIFT / KEY_PAUSE */
+   char ch;           /**< ASCII (or special) code of a non-extended key; 0 if none */
+};
+
 
 class Ps2Core {
 public:
@@ -44,6 +82,41 @@ public:
       RX_EMPT_FIELD = 0x00000100, /**< bit 10 of rd_data_reg; empty bit */
       RX_DATA_FIELD = 0x000000ff  /**< bits of 7..0 rd_data_reg; read data */
    };
+  /**
+   * key event flags
+   *
+   */
+   enum {
+      KEY_BREAK = 0x01, /**< key released (0xf0 prefix) */
+      KEY_EXT = 0x02,   /**< extended key (0xe0 prefix) */
+      KEY_SHIFT = 0x04, /**< a shift key was down */
+      KEY_PAUSE = 0x08  /**< Pause key (0xe1 sequence); press only, code 0x77 */
+   };
+  /**
+   * symbolic constant
+   *
+   */
+   enum {
+      INIT_BUSY = 0,       /**< init_poll(): reset still in progress */
+      INIT_RESET_MS = 2000,  /**< max wait for 0xfa 0xaa after reset */
+      INIT_ID_MS = 20,     /**< max wait for the mouse id after 0xaa */
+      INIT_ACK_MS = 100,   /**< max wait for the stream-mode ack */
+      KEY_QUEUE_SIZE = 16, /**< key event queue size (power of 2) */
+      KEY_EXT_CODE = 0x80, /**< add to an extended (0xe0) scan code for is_down() */
+      MOLE_KEYS = 16,      /**< # mole keys (a to p) */
+      CMD_QUEUE_SIZE = 16, /**< command byte queue size (power of 2) */
+      CMD_ACK_MS = 20,     /**< max wait for 0xfa before a retry */
+      CMD_RETRIES = 3      /**< max retries of a byte before giving up */
+   };
+  /**
+   * keyboard LED bits (set_kb_leds())
+   *
+   */
+   enum {
+      LED_SCROLL = 0x01,
+      LED_NUM = 0x02,
+      LED_CAPS = 0x04
+   };
   /* methods */
   /**
    * constructor.
@@ -97,9 +170,39 @@ public:
     *  -3: failure to set mouse to stream mode;
     *
     * @note keyboard does not require initialization; init() checks device id
+    * @note blocking; same as init_start() followed by init_poll() until
+    *       done, so it returns as soon as the device answers
     */
    int init();
 
+   /**
+    * start the device reset without waiting
+    *
+    * @note flushes the receiver fifo and the scan-code/packet decoders;
+    *       call init_poll() until it returns a result
+    */
+   void init_start();
+
+   /**
+    * advance the reset/identify sequence started by init_start()
+    *
+    * @return INIT_BUSY (0) while waiting; otherwise the init() result
+    *
+    * @note never waits; each step has a timeout (INIT_RESET_MS etc.);
+    *       the result is kept and returned by later calls
+    */
+   int init_poll();
+
+   /**
+    * reset latency of the last init
+    *
+    * @return microseconds from the reset command to the poll that
+    *         received 0xaa; 0 if not received
+    *
+    * @note resolution is the init_poll() interval
+    */
+   uint32_t init_latency_us();
+
    /**
     * get mouse activity
     *
@@ -109,9 +212,42 @@ public:
     * @return xmov return x-axis movement;
     * @return ymov return y-axis movement;
     *
+    * @note non-blocking; xmov/ymov are the sum of all packets received
+    *       since the last call; a button change ends the sum so that
+    *       no click is lost
     */
    int get_mouse_activity(int *lbtn, int *rbtn, int *xmov, int *ymov);
 
+   /**
+    * decode all received mouse bytes
+    *
+    * @return # complete packets added to the pending motion
+    *
+    * @note a byte expected to be a header (bit 3 = 1) is dropped
+    *       otherwise, so a misaligned stream realigns itself;
+    *       stops after a packet that changes the button state
+    */
+   int poll_mouse();
+
+   /**
+    * # bytes dropped to realign the mouse packet stream
+    *
+    */
+   uint32_t mouse_resyncs();
+
+#ifdef __cpp_impl_coroutine
+   /**
+    * wait for a mouse packet without blocking (for an AsyncTask)
+    *
+    * @return awaitable op; the task resumes when a packet is received
+    * @return lbtn, rbtn, xmov, ymov as in get_mouse_activity()
+    *
+    * @note usage: co_await ps2.get_mouse_activity_async(&l, &r, &x, &y);
+    */
+   Ps2MouseOp get_mouse_activity_async(int *lbtn, int *rbtn, int *xmov,
+         int *ymov);
+#endif
+
 
    /**
     * get keyboard activity
@@ -120,12 +256,189 @@ public:
     * @return ch return ASCII code of the pressed key
     *
     * @note special codes returned for non-ASCII keys (F1, ESC etc.)
+    * @note non-blocking; returns the next non-shift key press from
+    *       the event queue (extended keys and releases are skipped)
     */
    int get_kb_ch(char *ch);
 
+   /**
+    * decode all received keyboard bytes into key events
+    *
+    * @return # events added to the queue
+    *
+    * @note never waits; a partial code (e.g., 0xf0 alone) is kept
+    *       and completed by a later call
+    * @note also takes the 0xfa/0xfe replies of queued commands and
+    *       sends the next command byte
+    */
+   int poll_kb();
+
+   /**
+    * queue a keyboard command with an argument byte
+    *
+    * @param cmd command byte
+    * @param arg argument byte
+    * @return 0: queued; -1: queue full
+    *
+    * @note never waits; progress is made by poll_kb(); each byte must be
+    *       acknowledged (0xfa) before the next is sent
+    * @note a command whose byte fails CMD_RETRIES times is discarded
+    *       as a whole (see cmd_failed())
+    */
+   int send_cmd(uint8_t cmd, uint8_t arg);
+
+   /**
+    * queue a keyboard command without argument
+    *
+    * @param cmd command byte
+    * @return 0: queued; -1: queue full
+    */
+   int send_cmd(uint8_t cmd);
+
+   /**
+    * queue a set typematic rate/delay command (0xf3)
+    *
+    * @param rate repeat rate code 0 (30 chars/s) to 31 (2 chars/s)
+    * @param delay repeat delay code 0 (250 ms) to 3 (1 s)
+    * @return 0: queued; -1: queue full
+    */
+   int set_typematic(int rate, int delay);
+
+   /**
+    * queue a keyboard LED command (0xed)
+    *
+    * @param leds or of LED_SCROLL, LED_NUM, LED_CAPS
+    * @return 0: queued; -1: queue full
+    */
+   int set_kb_leds(int leds);
+
+   /**
+    * queue a scan code set command (0xf0)
+    *
+    * @param set scan code set 1 to 3
+    * @return 0: queued; -1: queue full; -2: set out of range
+    *
+    * @note the decoder handles set 2 (the power-up default) only
+    * @note 0 (query the current set) is rejected; its reply byte
+    *       would be decoded as a scan code
+    */
+   int set_scan_set(int set);
+
+   /**
+    * # command bytes not yet acknowledged
+    *
+    */
+   int cmd_pending();
+
+   /**
+    * # commands discarded after CMD_RETRIES failures
+    *
+    */
+   uint32_t cmd_failed();
+
+   /**
+    * remove the oldest key event from the queue
+    *
+    * @param ev pointer to the event
+    * @return 1: event returned; 0: queue empty
+    *
+    * @note calls poll_kb() first
+    */
+   int get_key_event(Ps2KeyEvent *ev);
+
+   /**
+    * # key events lost because the queue was full
+    *
+    */
+   uint32_t kb_dropped();
+
+   /**
+    * check whether a key is currently held
+    *
+    * @param key scan code; KEY_EXT_CODE + code for an extended key
+    * @return 1: key down; 0: otherwise
+    *
+    * @note state is updated by poll_kb() (also called by get_key_event()
+    *       and get_kb_ch()); a full event queue does not affect it
+    */
+   int is_down(int key);
+
+   /**
+    * get the mole keys currently held
+    *
+    * @return bit n set if key 'a'+n is down (n = 0 to 15)
+    *
+    */
+   uint16_t mole_keys();
+
+   /**
+    * get the mole keys pressed since the last call
+    *
+    * @return bit n set if key 'a'+n was pressed (cleared on read)
+    *
+    * @note a press and release between two polls is still reported;
+    *       typematic repeats are not
+    */
+   uint16_t mole_presses();
+
+   /**
+    * get the time of the latest press of a mole key
+    *
+    * @param n key index ('a'+n, 0 to 15)
+    * @return now_us() of the poll that received the make code
+    *
+    */
+   uint32_t mole_press_us(int n);
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
+   /* keyboard decoder state */
+   int kb_ext;        // 0xe0 received
+   int kb_brk;        // 0xf0 received
+   int kb_pause;      // # bytes of the 0xe1 pause sequence received
+   int kb_shift;      // bit 0: left shift down; bit 1: right shift down
+   Ps2KeyEvent kb_q[KEY_QUEUE_SIZE];
+   uint8_t kb_head;   // free running
+   uint8_t kb_tail;
+   uint32_t kb_drop;
+   uint32_t kb_down[8];   // pressed-key map, bit per (ext) scan code
+   uint16_t kb_mole;      // mole keys held
+   uint16_t kb_mole_hit;  // mole keys pressed since last mole_presses()
+   uint32_t kb_mole_us[MOLE_KEYS];
+   int kb_decode(uint8_t byte, uint32_t time_us);
+   int kb_put(uint8_t code, int flags, uint32_t time_us);
+   /* reset sequence state */
+   int init_state;
+   int init_res;
+   uint32_t init_t0;       // reset sent (us)
+   uint32_t init_t;        // current step started (us)
+   uint32_t init_tmo;      // current step timeout (us)
+   uint32_t init_lat;
+   void init_end(int res);
+   /* command queue: bits 7..0 byte; bit 8 last byte of a command */
+   uint16_t cmd_q[CMD_QUEUE_SIZE];
+   uint8_t cmd_head;     // free running
+   uint8_t cmd_tail;
+   int cmd_wait;         // byte at cmd_tail sent; waiting for reply
+   int cmd_retry;
+   uint32_t cmd_t;       // time the byte was sent (us)
+   uint32_t cmd_fail;
+   int cmd_put(uint8_t cmd, int arg);
+   void cmd_pump(uint32_t now);
+   void cmd_reply(uint8_t byte);
+   void cmd_retry_or_drop();
+   /* mouse decoder state */
+   uint8_t ms_b[3];   // packet bytes
+   int ms_cnt;        // # bytes received
+   int ms_btn;        // button bits of the latest packet
+   int ms_dx, ms_dy;  // pending motion
+   int ms_pkts;       // # packets in the pending motion
+   int ms_hold;       // button change pending; stop decoding
+   uint32_t ms_resync;
+   int ms_decode(uint8_t byte);
+   static void decode_mouse(uint8_t b1, uint8_t b2, uint8_t b3, int *lbtn,
+         int *rbtn, int *xmov, int *ymov);
 };
 
 #endif  // _PS2_H_INCLUDED
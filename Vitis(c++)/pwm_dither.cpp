@@ -0,0 +1,138 @@
+/*****************************************************************//**
+ * @file pwm_dither.cpp
+ *
+ * @brief implementation of the pwm sigma-delta dither engine
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "pwm_dither.h"
+
+enum {
+   FRAC_MASK = (1 << PwmDither::DITHER_BITS) - 1
+};
+
+PwmDither::PwmDither(PwmCore *pwm_p) {
+   pwm = pwm_p;
+   for (int i = 0; i < CHANNELS; i++) {
+      base[i] = 0;
+      frac[i] = 0;
+      acc[i] = 0;
+      shown[i] = 0xffff;        // first write always goes out
+   }
+   dmask = 0;
+   running = 0;
+   period_tick = 0;
+   due = 0;
+   st_start = 0;                // set by start()
+   st_busy = 0;
+   st_periods = 0;
+}
+
+PwmDither::~PwmDither() {
+}
+
+void PwmDither::start(int freq) {
+   if (freq < 1)
+      freq = 1;
+   pwm->set_freq(freq);
+   period_tick = (uint64_t) SYS_CLK_FREQ * 1000000 / freq;
+   running = 1;
+   due = now_tick();
+   clear_stats();
+}
+
+void PwmDither::stop() {
+   running = 0;
+   for (int ch = 0; ch < CHANNELS; ch++)
+      write(ch, base[ch]);
+}
+
+// write a register if its value changed
+int PwmDither::write(int ch, uint16_t d) {
+   if (d == shown[ch])
+      return (0);
+   shown[ch] = d;
+   pwm->set_duty((int) d, ch);
+   return (1);
+}
+
+void PwmDither::set_duty(int duty, int channel) {
+   int ch;
+
+   ch = channel & (CHANNELS - 1);
+   if (duty < 0)
+      duty = 0;
+   if (duty > MAX)
+      duty = MAX;
+   base[ch] = (uint16_t) (duty >> DITHER_BITS);
+   frac[ch] = (uint8_t) (duty & FRAC_MASK);
+   if (frac[ch])
+      dmask = dmask | bit(ch);
+   else
+      dmask = dmask & ~bit(ch);
+   // accumulator kept: a slow fade stays on the same pattern
+   if (!frac[ch] || !running)
+      write(ch, base[ch]);
+}
+
+int PwmDither::update() {
+   uint32_t m;
+   uint16_t d;
+   int ch, n;
+
+   n = 0;
+   m = dmask;
+   for (ch = 0; m; ch++, m = m >> 1) {
+      if (!(m & 0x01))
+         continue;
+      acc[ch] = acc[ch] + frac[ch];
+      d = base[ch] + (acc[ch] >> DITHER_BITS);   // carry: one count up
+      acc[ch] = acc[ch] & FRAC_MASK;
+      n = n + write(ch, d);
+   }
+   return (n);
+}
+
+int PwmDither::poll() {
+   uint64_t now;
+   int n;
+
+   if (!running)
+      return (0);
+   now = now_tick();
+   if ((int64_t) (now - due) < 0)
+      return (0);
+   n = update();
+   st_periods++;
+   due = due + period_tick;
+   if ((int64_t) (due - now) < 0)
+      due = now + period_tick;  // far behind: restart timing
+   st_busy = st_busy + (now_tick() - now);
+   return (n);
+}
+
+uint32_t PwmDither::rate_hz() {
+   uint64_t el;
+
+   el = now_tick() - st_start;
+   if (el == 0)
+      return (0);
+   return ((uint32_t) ((uint64_t) st_periods * SYS_CLK_FREQ * 1000000 / el));
+}
+
+uint32_t PwmDither::cpu_ppm() {
+   uint64_t el;
+
+   el = now_tick() - st_start;
+   if (el == 0)
+      return (0);
+   return ((uint32_t) (st_busy * 1000000 / el));
+}
+
+void PwmDither::clear_stats() {
+   st_start = now_tick();
+   st_busy = 0;
+   st_periods = 0;
+}
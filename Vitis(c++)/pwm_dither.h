@@ -0,0 +1,121 @@
+/*****************************************************************//**
+ * @file pwm_dither.h
+ *
+ * @brief Sigma-delta (temporal) dithering for extra PwmCore resolution
+ *
+ * Description:
+ *  - duty is given with DITHER_BITS extra fraction bits
+ *    (RESOLUTION_BITS + DITHER_BITS = 16 bits effective)
+ *  - once per pwm period the fraction is added to a per-channel
+ *    error accumulator; its carry raises the duty register by one
+ *    count for that period (first-order sigma-delta)
+ *  - the average duty over 2^DITHER_BITS periods is exact; the
+ *    pattern repeats fastest for fractions near 1/2
+ *  - only channels with a non-zero fraction are touched by update();
+ *    a register is written only when its value changes
+ *  - poll() from the main loop; the cpu share of the updates is
+ *    measured
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _PWM_DITHER_H_INCLUDED
+#define _PWM_DITHER_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+
+/**
+ * sigma-delta dither engine for the 8 pwm channels
+ *  - polling must be frequent compared with the pwm period; a late
+ *    poll only delays the pattern (average stays exact)
+ */
+class PwmDither {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      CHANNELS = 8,                 /**< # pwm channels of the core */
+      DITHER_BITS = 6,              /**< extra fraction bits */
+      BITS = PwmCore::RESOLUTION_BITS + DITHER_BITS, /**< effective bits */
+      MAX = PwmCore::MAX << DITHER_BITS  /**< 100% duty cycle */
+   };
+
+   /**
+    * constructor
+    *
+    * @param pwm_p pointer to the pwm core
+    */
+   PwmDither(PwmCore *pwm_p);
+   ~PwmDither();  // not used
+
+   /**
+    * set the pwm frequency and start dithering at its period
+    *
+    * @param freq pwm switching frequency
+    */
+   void start(int freq);
+
+   /**
+    * stop dithering; channels keep the integer part of the duty
+    */
+   void stop();
+
+   /**
+    * set duty cycle in extended format
+    *
+    * @param duty duty cycle (between 0 and MAX)
+    * @param channel pwm channel number
+    */
+   void set_duty(int duty, int channel);
+
+   /**
+    * advance all dithered channels if a pwm period has passed
+    *
+    * @return # duty registers written
+    */
+   int poll();
+
+   /**
+    * advance all dithered channels by one period (no deadline check)
+    *
+    * @return # duty registers written
+    */
+   int update();
+
+   /**
+    * periods per second since start() or clear_stats()
+    */
+   uint32_t rate_hz();
+
+   /**
+    * cpu time spent in updates, in millionths of elapsed time
+    *
+    * @note excludes the early-return polls (one timer read each)
+    */
+   uint32_t cpu_ppm();
+
+   /**
+    * restart the rate and cpu measurement
+    */
+   void clear_stats();
+
+private:
+   PwmCore *pwm;
+   uint16_t base[CHANNELS];   // integer part of the duty
+   uint8_t frac[CHANNELS];    // fraction part
+   uint8_t acc[CHANNELS];     // error accumulator
+   uint16_t shown[CHANNELS];  // last register value
+   uint32_t dmask;            // channels with a fraction
+   int running;
+   uint64_t period_tick;
+   uint64_t due;
+   uint64_t st_start;         // statistics
+   uint64_t st_busy;
+   uint32_t st_periods;
+   int write(int ch, uint16_t d);
+};
+
+#endif  // _PWM_DITHER_H_INCLUDED
@@ -0,0 +1,169 @@
+/*****************************************************************//**
+ * @file pwm_fade.cpp
+ *
+ * @brief implementation of the pwm fade/breathe engine
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "pwm_fade.h"
+#include "pwm_gamma.h"
+
+enum {
+   FADE_HOLD = 0,
+   FADE_RAMP,
+   FADE_BREATHE
+};
+
+static int clamp_level(int level) {
+   if (level < 0)
+      return (0);
+   if (level > PwmFade::LEVEL_MAX)
+      return (PwmFade::LEVEL_MAX);
+   return (level);
+}
+
+PwmFade::PwmFade(PwmCore *pwm_p) {
+   pwm = pwm_p;
+   dither = 0;
+   for (int i = 0; i < CHANNELS; i++) {
+      q[i] = 0;
+      delta[i] = 0;
+      lo[i] = 0;
+      hi[i] = 0;
+      mode[i] = FADE_HOLD;
+      duty[i] = 0xffffffff;     // first step always writes
+   }
+   due = 0;
+   set_frame(10);
+}
+
+PwmFade::~PwmFade() {
+}
+
+void PwmFade::set_frame(uint32_t ms) {
+   if (ms == 0)
+      ms = 1;
+   frame_ms = ms;
+   frame_tick = (uint64_t) ms * 1000 * SYS_CLK_FREQ;
+}
+
+// # frames in ms (at least 1)
+int PwmFade::frames(uint32_t ms) {
+   int n;
+
+   n = (int) (ms / frame_ms);
+   return ((n < 1) ? 1 : n);
+}
+
+void PwmFade::set_dither(PwmDither *dither_p) {
+   dither = dither_p;
+   for (int i = 0; i < CHANNELS; i++)
+      duty[i] = 0xffffffff;     // rescale on the next write
+}
+
+// write the duty of a channel if it changed
+int PwmFade::write(int ch) {
+   uint32_t d;
+   int i, f;
+
+   i = q[ch] >> 8;
+   if (dither == 0) {
+      d = PwmGamma::LUT[i];
+   } else {
+      // linear between table entries; f != 0 implies i < LEVEL_MAX
+      f = q[ch] & 0xff;
+      d = (uint32_t) PwmGamma::LUT[i] << PwmDither::DITHER_BITS;
+      if (f)
+         d = d + (((PwmGamma::LUT[i + 1] - PwmGamma::LUT[i]) * f)
+               >> (8 - PwmDither::DITHER_BITS));
+   }
+   if (d == duty[ch])
+      return (0);
+   duty[ch] = d;
+   if (dither == 0)
+      pwm->set_duty((int) d, ch);
+   else
+      dither->set_duty((int) d, ch);
+   return (1);
+}
+
+void PwmFade::set(int ch, int level) {
+   ch = ch & (CHANNELS - 1);
+   q[ch] = clamp_level(level) << 8;
+   mode[ch] = FADE_HOLD;
+   write(ch);
+}
+
+void PwmFade::fade(int ch, int level, uint32_t ms) {
+   ch = ch & (CHANNELS - 1);
+   hi[ch] = clamp_level(level) << 8;
+   delta[ch] = (hi[ch] - q[ch]) / frames(ms);
+   if (delta[ch] == 0)
+      delta[ch] = (hi[ch] > q[ch]) ? 1 : -1;
+   mode[ch] = (hi[ch] == q[ch]) ? FADE_HOLD : FADE_RAMP;
+   if (due == 0)
+      due = now_tick() + frame_tick;
+}
+
+void PwmFade::breathe(int ch, int lo_level, int hi_level, uint32_t period_ms) {
+   ch = ch & (CHANNELS - 1);
+   lo[ch] = clamp_level(lo_level) << 8;
+   hi[ch] = clamp_level(hi_level) << 8;
+   if (q[ch] < lo[ch] || q[ch] > hi[ch])
+      q[ch] = lo[ch];
+   // up and down in one period
+   delta[ch] = 2 * (hi[ch] - lo[ch]) / frames(period_ms);
+   if (delta[ch] == 0)
+      delta[ch] = 1;
+   mode[ch] = FADE_BREATHE;
+   if (due == 0)
+      due = now_tick() + frame_tick;
+}
+
+int PwmFade::busy(int ch) {
+   return (mode[ch & (CHANNELS - 1)] != FADE_HOLD);
+}
+
+int PwmFade::step() {
+   int ch, n;
+   int32_t v;
+
+   n = 0;
+   for (ch = 0; ch < CHANNELS; ch++) {
+      if (mode[ch] == FADE_HOLD)
+         continue;
+      v = q[ch] + delta[ch];
+      if (mode[ch] == FADE_RAMP) {
+         // stop at the target from either side
+         if ((delta[ch] > 0 && v >= hi[ch]) || (delta[ch] < 0 && v <= hi[ch])) {
+            v = hi[ch];
+            mode[ch] = FADE_HOLD;
+         }
+      } else if (v >= hi[ch]) {
+         v = hi[ch];
+         delta[ch] = -delta[ch];
+      } else if (v <= lo[ch]) {
+         v = lo[ch];
+         delta[ch] = -delta[ch];
+      }
+      q[ch] = v;
+      n = n + write(ch);
+   }
+   return (n);
+}
+
+int PwmFade::poll() {
+   uint64_t now;
+
+   if (due == 0)
+      return (0);               // nothing started yet
+   now = now_tick();
+   if ((int64_t) (now - due) < 0)
+      return (0);
+   due = due + frame_tick;
+   if ((int64_t) (due - now) < 0)
+      due = now + frame_tick;   // far behind: restart timing
+   return (step());
+}
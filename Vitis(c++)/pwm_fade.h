@@ -0,0 +1,131 @@
+/*****************************************************************//**
+ * @file pwm_fade.h
+ *
+ * @brief Integer fade/breathe engine for the PwmCore channels
+ *
+ * Description:
+ *  - brightness per channel is an 8-bit level kept in Q8 fixed point
+ *  - fade: linear ramp to a target level; breathe: triangle between
+ *    two levels, forever
+ *  - all channels step together on a clock-tick deadline (frame);
+ *    a step is an add, a compare and a gamma LUT read (PwmGamma)
+ *  - the duty register is written only when the duty changes
+ *  - the only divide is in fade()/breathe() (once per request)
+ *  - optional PwmDither output: the Q8 fraction interpolates between
+ *    table entries, so slow fades at low levels do not step
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _PWM_FADE_H_INCLUDED
+#define _PWM_FADE_H_INCLUDED
+
+#include "chu_init.h"
+#include "gpio_cores.h"
+#include "pwm_dither.h"
+
+/**
+ * fade/breathe engine
+ */
+class PwmFade {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      CHANNELS = 8,      /**< # pwm channels of the core */
+      LEVEL_MAX = 255    /**< max brightness level */
+   };
+
+   /**
+    * constructor
+    *
+    * @param pwm_p pointer to the pwm core
+    * @note frame period is 10 ms; all channels at level 0
+    */
+   PwmFade(PwmCore *pwm_p);
+   ~PwmFade();  // not used
+
+   /**
+    * set the frame period
+    *
+    * @param ms step interval in millisecond
+    */
+   void set_frame(uint32_t ms);
+
+   /**
+    * send duties through a dither engine
+    *
+    * @param dither_p pointer to a started dither engine; 0 for direct
+    *        10-bit register writes
+    */
+   void set_dither(PwmDither *dither_p);
+
+   /**
+    * set a channel level now (ends a fade/breathe)
+    *
+    * @param ch channel (0 to CHANNELS-1)
+    * @param level brightness 0 to LEVEL_MAX
+    */
+   void set(int ch, int level);
+
+   /**
+    * ramp a channel to a level
+    *
+    * @param ch channel (0 to CHANNELS-1)
+    * @param level target brightness 0 to LEVEL_MAX
+    * @param ms ramp time (rounded to frames)
+    */
+   void fade(int ch, int level, uint32_t ms);
+
+   /**
+    * breathe a channel between two levels
+    *
+    * @param ch channel (0 to CHANNELS-1)
+    * @param lo low level
+    * @param hi high level
+    * @param period_ms time of one low-high-low cycle
+    */
+   void breathe(int ch, int lo, int hi, uint32_t period_ms);
+
+   /**
+    * check whether a channel is fading or breathing
+    *
+    * @param ch channel
+    * @return 1: moving; 0: holding its level
+    */
+   int busy(int ch);
+
+   /**
+    * step all moving channels if the frame deadline has passed
+    *
+    * @return # duty registers written
+    */
+   int poll();
+
+   /**
+    * step all moving channels once (no deadline check)
+    *
+    * @return # duty registers written
+    * @note used by poll(); exposed for cost measurement
+    */
+   int step();
+
+private:
+   PwmCore *pwm;
+   PwmDither *dither;
+   int32_t q[CHANNELS];       // level, Q8
+   int32_t delta[CHANNELS];   // Q8 change per frame
+   int32_t lo[CHANNELS];      // Q8 limits (fade: target in hi)
+   int32_t hi[CHANNELS];
+   uint8_t mode[CHANNELS];
+   uint32_t duty[CHANNELS];   // last duty written
+   uint32_t frame_ms;
+   uint64_t frame_tick;
+   uint64_t due;
+   int frames(uint32_t ms);
+   int write(int ch);
+};
+
+#endif  // _PWM_FADE_H_INCLUDED
@@ -0,0 +1,67 @@
+/*****************************************************************//**
+ * @file pwm_gamma.h
+ *
+ * @brief Compile-time gamma (perceptual brightness) table for PwmCore
+ *
+ * Description:
+ *  - maps an 8-bit brightness (0-255) to a PwmCore duty (0-MAX)
+ *  - curve: CIE 1976 lightness inverted (L* = 100 x level/255 to
+ *    luminance); close to gamma 2.2-2.5 but needs only + and x,
+ *    so it is a constexpr (C++11) function
+ *  - the table is built by template expansion at compile time and
+ *    placed in read-only memory; no float code is linked
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _PWM_GAMMA_H_INCLUDED
+#define _PWM_GAMMA_H_INCLUDED
+
+#include "gpio_cores.h"
+
+/* relative luminance (0.0-1.0) of lightness l (0-100) */
+constexpr double pwm_cie_y(double l) {
+   return ((l > 8.0) ?
+         ((l + 16.0) / 116.0) * ((l + 16.0) / 116.0) * ((l + 16.0) / 116.0) :
+         l / 903.3);
+}
+
+/**
+ * gamma-corrected duty of a brightness level
+ *
+ * @param level brightness 0 to 255
+ * @return duty 0 to PwmCore::MAX
+ */
+constexpr uint16_t pwm_gamma(int level) {
+   return ((uint16_t) (pwm_cie_y(100.0 * level / 255.0) * (double) PwmCore::MAX + 0.5));
+}
+
+/* table of the levels in the parameter pack */
+template<int ... L>
+struct PwmGammaTable {
+   static const uint16_t LUT[sizeof...(L)];
+};
+
+template<int ... L>
+const uint16_t PwmGammaTable<L...>::LUT[sizeof...(L)] = { pwm_gamma(L)... };
+
+/* expands to PwmGammaTable<0, 1, ..., N-1> */
+template<int N, int ... L>
+struct PwmGammaGen: PwmGammaGen<N - 1, N - 1, L...> {
+};
+
+template<int ... L>
+struct PwmGammaGen<0, L...> {
+   typedef PwmGammaTable<L...> type;
+};
+
+/**
+ * gamma table: PwmGamma::LUT[level], level 0 to 255
+ */
+typedef PwmGammaGen<256>::type PwmGamma;
+
+static_assert(pwm_gamma(0) == 0 && pwm_gamma(255) == PwmCore::MAX,
+      "gamma table must span the full duty range");
+
+#endif  // _PWM_GAMMA_H_INCLUDED
@@ -81,3 +81,36 @@ uint8_t SpiCore::transfer(uint8_t wr_data) {
    return ((uint8_t) rd_data);
 }
 
+#ifdef __cpp_impl_coroutine
+SpiTransferOp SpiCore::transfer_async(uint8_t wr_data) {
+   return (SpiTransferOp(this, wr_data));
+}
+
+SpiTransferOp::SpiTransferOp(SpiCore *core, uint8_t wr_data) {
+   spi = core;
+   data = wr_data;
+   state = 0;
+}
+
+/* same steps as transfer(); each wait returns instead of spinning */
+int SpiTransferOp::poll() {
+   if (state == 0) {
+      if (!spi->ready())
+         return (0);
+      io_write(spi->base_addr, SpiCore::WRITE_DATA_REG, (uint32_t) data);
+      state = 1;
+   }
+   if (state == 1) {
+      if (!spi->ready())
+         return (0);
+      data = (uint8_t) (io_read(spi->base_addr, SpiCore::RD_DATA_REG)
+            & SpiCore::RX_DATA_FIELD);
+      state = 2;
+   }
+   return (1);
+}
+
+uint8_t SpiTransferOp::await_resume() {
+   return (data);
+}
+#endif  // __cpp_impl_coroutine
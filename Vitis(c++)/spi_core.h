@@ -11,6 +11,26 @@
 #define _SPI_CORE_H_INCLUDED
 
 #include "chu_init.h"
+#include "async_io.h"
+
+#ifdef __cpp_impl_coroutine
+class SpiCore;
+
+/**
+ * awaitable spi transfer (see SpiCore::transfer_async())
+ *  - co_await returns the 8-bit read data
+ */
+class SpiTransferOp: public AsyncOp {
+public:
+   SpiTransferOp(SpiCore *core, uint8_t wr_data);
+   int poll();
+   uint8_t await_resume();
+private:
+   SpiCore *spi;
+   uint8_t data;   // write data; read data once done
+   int state;      // 0: wait to write; 1: wait for read data; 2: done
+};
+#endif
 
 /**
  *  spi core driver:
@@ -127,7 +147,23 @@ public:
     */
    uint8_t transfer(uint8_t wr_data);
 
+#ifdef __cpp_impl_coroutine
+   /**
+    * non-blocking version of transfer() for an AsyncTask
+    *
+    *@param wr_data 8-bit write data (to slave)
+    *@return awaitable op; co_await yields 8-bit read data
+    *
+    *@note usage: rd = co_await spi.transfer_async(wr);
+    *
+    */
+   SpiTransferOp transfer_async(uint8_t wr_data);
+#endif
+
 private:
+#ifdef __cpp_impl_coroutine
+   friend class SpiTransferOp;
+#endif
    /* variable to keep track of current status */
    uint32_t base_addr;
    uint32_t ss_n_data;
@@ -14,61 +14,206 @@ SsegCore::SsegCore(uint32_t core_base_addr) {
    // i.e., HI_PTN[0] is the leftmost led
    const uint8_t HI_PTN[]={0xff,0xf9,0x89,0xff,0xff,0xff,0xff,0xff};
    base_addr = core_base_addr;
-   write_8ptn((uint8_t*) HI_PTN);
-   set_dp(0x02);
+   ptn_buf[0] = 0;
+   ptn_buf[1] = 0;
+   dp = 0xff;
+   dirty = 0x03;     // first commit writes both registers
+   stage_8ptn(HI_PTN);
+   stage_dp(0x02);
+   commit();
 }
 
 SsegCore::~SsegCore() {
 }
 // not used
 
-void SsegCore::write_led() {
-   int i, p;
-   uint32_t word = 0;
+// move bit i of a 4-bit dp nibble to bit 7 of byte i
+// (x 0x00204081 places 4 copies 7 bits apart; the mask keeps bit i of copy i)
+static inline uint32_t dp_spread(uint32_t nibble) {
+   return (((nibble * 0x00204081UL) & 0x01010101UL) << 7);
+}
 
-   // pack left 4 patterns into a 32-bit word
-   // ptn_buf[0] is the leftmost led
-   for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[3 - i];
-   }
-   // incorporate decimal points (bit 7 of pattern)
-   for (i = 0; i < 4; i++) {
-      p = bit_read(dp, i);
-      bit_write(word, 7 + 8 * i, p);
-   }
-   io_write(base_addr, DATA_LOW_REG, word);
-   // pack right 4 patterns into a 32-bit word
-   for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[7 - i];
+void SsegCore::stage_1ptn(uint8_t pattern, int pos) {
+   uint32_t word;
+   int h, sh;
+
+   h = (pos >> 2) & 0x01;
+   sh = 8 * (pos & 0x03);
+   word = (ptn_buf[h] & ~(0xffUL << sh)) | ((uint32_t) pattern << sh);
+   if (word != ptn_buf[h]) {
+      ptn_buf[h] = word;
+      dirty = dirty | bit(h);
    }
-   // incorporate decimal points
-   for (i = 0; i < 4; i++) {
-      p = bit_read(dp, 4 + i);
-      bit_write(word, 7 + 8 * i, p);
+}
+
+void SsegCore::stage_8ptn(const uint8_t *ptn_array) {
+   uint32_t word;
+   int h;
+
+   for (h = 0; h < 2; h++) {
+      word = (uint32_t) ptn_array[0] | ((uint32_t) ptn_array[1] << 8) |
+            ((uint32_t) ptn_array[2] << 16) | ((uint32_t) ptn_array[3] << 24);
+      if (word != ptn_buf[h]) {
+         ptn_buf[h] = word;
+         dirty = dirty | bit(h);
+      }
+      ptn_array = ptn_array + 4;
    }
-   io_write(base_addr, DATA_HIGH_REG, word);
 }
 
-void SsegCore::write_8ptn(uint8_t *ptn_array) {
-   int i;
+// set decimal points,
+// bits turn on the corresponding decimal points
+void SsegCore::stage_dp(uint8_t pt) {
+   uint8_t diff;
 
-   for (i = 0; i < 8; i++) {
-      ptn_buf[i] = *ptn_array;
-      ptn_array++;
+   pt = ~pt;     // active low
+   diff = dp ^ pt;
+   if (diff & 0x0f)
+      dirty = dirty | 0x01;
+   if (diff & 0xf0)
+      dirty = dirty | 0x02;
+   dp = pt;
+}
+
+int SsegCore::commit() {
+   uint32_t word;
+   int h, n;
+
+   n = 0;
+   for (h = 0; h < 2; h++) {
+      if (!bit_read(dirty, h))
+         continue;
+      // dp replaces bit 7 of each pattern
+      word = (ptn_buf[h] & 0x7f7f7f7fUL) | dp_spread((dp >> (4 * h)) & 0x0f);
+      io_write(base_addr, DATA_LOW_REG + h, word);
+      n++;
    }
-   write_led();
+   dirty = 0;
+   return (n);
+}
+
+void SsegCore::write_8ptn(uint8_t *ptn_array) {
+   stage_8ptn(ptn_array);
+   commit();
 }
 
 void SsegCore::write_1ptn(uint8_t pattern, int pos) {
-   ptn_buf[pos] = pattern;
-   write_led();
+   stage_1ptn(pattern, pos);
+   commit();
 }
 
-// set decimal points,
-// bits turn on the corresponding decimal points
 void SsegCore::set_dp(uint8_t pt) {
-   dp = ~pt;     // active low
-   write_led();
+   stage_dp(pt);
+   commit();
+}
+
+uint32_t SsegCore::bin2bcd(uint32_t n) {
+   uint32_t bcd, c;
+   int i, top;
+
+   // 2^27 > MAX_UINT: 27 bits; below 2^16 (scores, readings) 16 bits
+   top = (n >> 16) ? 27 : 16;
+   // first 3 bits need no correction (value < 8)
+   bcd = n >> (top - 3);
+   // shift in the other bits; before each, add 3 to digits >= 5
+   for (i = top - 4; i >= 0; i--) {
+      c = ((bcd + 0x33333333UL) & 0x88888888UL) >> 3;   // 1: digit >= 5
+      bcd = bcd + (c << 1) + c;
+      bcd = (bcd << 1) | ((n >> i) & 0x01);
+   }
+   return (bcd);
+}
+
+// n: magnitude; point: # fraction digits (0: no dp)
+int SsegCore::show_field(uint32_t n, int neg, int point, int pos, int len,
+      int format) {
+   const uint8_t BLANK = 0xff;
+   const uint8_t MINUS = 0xbf;
+   uint32_t bcd;
+   uint8_t pt, field;
+   int nd, total, lsd, i, k, ok;
+
+   if (pos < 0)
+      pos = 0;
+   if (len > 8 - pos)
+      len = 8 - pos;
+   bcd = bin2bcd(n);
+   nd = 1;
+   while (nd < 8 && (bcd >> (4 * nd)))
+      nd++;
+   if (nd < point + 1)
+      nd = point + 1;                    // leading 0 before the dp
+   total = nd + neg;
+   ok = (n <= MAX_UINT) && (total <= len);
+   if (format == FIELD_ZERO && ok) {
+      nd = len - neg;                    // zeros fill the field
+      total = len;
+   }
+   lsd = (format == FIELD_LEFT && ok) ? pos + len - total : pos;
+   for (i = 0; i < len; i++) {
+      k = pos + i - lsd;                 // digit # in the number
+      if (!ok || (k >= nd && k < total))
+         stage_1ptn(MINUS, pos + i);     // sign left of the digits
+      else if (k < 0 || k >= total)
+         stage_1ptn(BLANK, pos + i);
+      else
+         stage_1ptn(h2s((bcd >> (4 * k)) & 0x0f), pos + i);
+   }
+   // decimal points of the field
+   field = (uint8_t) (((1 << len) - 1) << pos);
+   pt = (uint8_t) ~dp & ~field;
+   if (ok && point > 0)
+      pt = pt | (uint8_t) bit(lsd + point);
+   stage_dp(pt);
+   commit();
+   return (ok);
+}
+
+int SsegCore::show_uint(uint32_t n, int pos, int len, int format) {
+   return (show_field(n, 0, 0, pos, len, format));
+}
+
+int SsegCore::show_uint(uint32_t n) {
+   return (show_field(n, 0, 0, 0, 8, FIELD_RIGHT));
+}
+
+int SsegCore::show_int(int n, int pos, int len, int format) {
+   uint32_t un;
+
+   un = (n < 0) ? 0 - (uint32_t) n : (uint32_t) n;
+   return (show_field(un, n < 0, 0, pos, len, format));
+}
+
+int SsegCore::show_int(int n) {
+   return (show_int(n, 0, 8, FIELD_RIGHT));
+}
+
+int SsegCore::show_fixed(int32_t q, int frac_bits, int digit, int pos,
+      int len, int format) {
+   uint32_t uq, v, frac, mask;
+   int i;
+
+   if (frac_bits > 28)
+      frac_bits = 28;
+   if (digit > 7)
+      digit = 7;
+   uq = (q < 0) ? 0 - (uint32_t) q : (uint32_t) q;
+   mask = (1UL << frac_bits) - 1;
+   v = uq >> frac_bits;
+   frac = uq & mask;
+   // append fraction digits: x10 by shift/add, digit = top bits
+   for (i = 0; i < digit; i++) {
+      if (v > MAX_UINT)
+         break;                          // too big anyway
+      frac = (frac << 3) + (frac << 1);
+      v = (v << 3) + (v << 1) + (frac >> frac_bits);
+      frac = frac & mask;
+   }
+   return (show_field(v, q < 0 && v != 0, digit, pos, len, format));
+}
+
+int SsegCore::show_fixed(int32_t q, int frac_bits, int digit) {
+   return (show_fixed(q, frac_bits, digit, 0, 8, FIELD_RIGHT));
 }
 
 // convert a hex digit to
@@ -15,9 +15,16 @@
 /**
  * seven-segment LED core driver
  *  - control 8/4-digit seven-segment LED display.
- *  - an 8-element buffer (ptn_buf[]) stores the 8 7-seg patterns.
+ *  - two 32-bit words (ptn_buf[]) store the 8 7-seg patterns in
+ *    register layout (digit 0 in bits 7-0 of the low word)
  *  - dp stores the decimal point pattern
- *  - the 7-seg pattern and dp combined in write_led()
+ *  - stage_xxx() update the buffer and mark the changed half (low or
+ *    high 4 digits) dirty; commit() combines pattern and dp with word
+ *    operations and writes each dirty register once
+ *  - write_xxx()/set_dp() are stage + commit
+ *  - show_xxx() render a number into a field of digits; binary to
+ *    BCD is a double dabble (shift and add-3) on all 8 digits of a
+ *    32-bit word at once, so no divide is used
  *  - will work for 4-digit 7-seg display (ignoring upper 4 digits)
  *  - if modified for an 8-by-8 LED matrix, dp portion should be removed
  */
@@ -31,6 +38,16 @@ public:
       DATA_HIGH_REG = 1 /**< 32-bit data for left 4 digits */
    };
 
+   /**
+    * number field format
+    */
+   enum {
+      FIELD_RIGHT = 0,  /**< right aligned, leading blanks */
+      FIELD_LEFT = 1,   /**< left aligned, trailing blanks */
+      FIELD_ZERO = 2,   /**< right aligned, leading zeros */
+      MAX_UINT = 99999999 /**< largest number of 8 digits */
+   };
+
    /**
     * constructor
     *
@@ -70,13 +87,105 @@ public:
     */
    void set_dp(uint8_t pt);
 
+   /**
+    * stage one 7-seg pattern (no register write)
+    * @param pattern 7-seg pattern
+    * @param pos digit position (0 is least significant digit)
+    */
+   void stage_1ptn(uint8_t pattern, int pos);
+
+   /**
+    * stage 8 7-seg patterns (no register write)
+    * @param ptn_array pointer to an 8-element pattern array
+    */
+   void stage_8ptn(const uint8_t *ptn_array);
+
+   /**
+    * stage decimal points (no register write)
+    * @param pt decimal point patterns (same format as set_dp())
+    */
+   void stage_dp(uint8_t pt);
+
+   /**
+    * write the changed halves of the display
+    * @return # registers written (0 to 2)
+    */
+   int commit();
+
+   /**
+    * convert a binary number to 8 packed BCD digits
+    * @param n number (0 to MAX_UINT)
+    * @return BCD digits; digit 0 in bits 3-0
+    */
+   static uint32_t bin2bcd(uint32_t n);
+
+   /**
+    * show an unsigned number on all 8 digits (right aligned)
+    * @param n number
+    * @return 1: shown; 0: too many digits (field shows "-")
+    */
+   int show_uint(uint32_t n);
+
+   /**
+    * show an unsigned number in a field
+    * @param n number
+    * @param pos least significant digit of the field
+    * @param len # digits of the field
+    * @param format FIELD_RIGHT, FIELD_LEFT or FIELD_ZERO
+    * @return 1: shown; 0: too many digits (field shows "-")
+    * @note other digits are kept; decimal points of the field cleared
+    */
+   int show_uint(uint32_t n, int pos, int len, int format);
+
+   /**
+    * show a signed number on all 8 digits (right aligned)
+    * @param n number
+    * @return 1: shown; 0: too many digits (field shows "-")
+    */
+   int show_int(int n);
+
+   /**
+    * show a signed number in a field
+    * @param n number
+    * @param pos least significant digit of the field
+    * @param len # digits of the field (including the "-" sign)
+    * @param format FIELD_RIGHT, FIELD_LEFT or FIELD_ZERO
+    * @return 1: shown; 0: too many digits (field shows "-")
+    */
+   int show_int(int n, int pos, int len, int format);
+
+   /**
+    * show a fixed-point number on all 8 digits (right aligned)
+    * @param q fixed-point value (value = q / 2^frac_bits)
+    * @param frac_bits # fraction bits (0 to 28)
+    * @param digit # fraction digits (truncated)
+    * @return 1: shown; 0: too many digits (field shows "-")
+    */
+   int show_fixed(int32_t q, int frac_bits, int digit);
+
+   /**
+    * show a fixed-point number in a field
+    * @param q fixed-point value (value = q / 2^frac_bits)
+    * @param frac_bits # fraction bits (0 to 28)
+    * @param digit # fraction digits (truncated)
+    * @param pos least significant digit of the field
+    * @param len # digits of the field (including the "-" sign)
+    * @param format FIELD_RIGHT, FIELD_LEFT or FIELD_ZERO
+    * @return 1: shown; 0: too many digits (field shows "-")
+    * @note decimal point lit on the units digit; at least one
+    *       integer digit is shown (e.g., "0.50")
+    */
+   int show_fixed(int32_t q, int frac_bits, int digit, int pos, int len,
+         int format);
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
-   uint8_t ptn_buf[8];    // led pattern buffer
+   uint32_t ptn_buf[2];   // led patterns, 4 per word
    uint8_t dp;            // decimal point
-   /* methods */
-   void write_led();      // write patterns to reg
+   uint8_t dirty;         // bit 0: low word; bit 1: high word
+   int show_field(uint32_t n, int neg, int point, int pos, int len,
+         int format);
 }
 ;
 
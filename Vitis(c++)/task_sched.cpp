@@ -0,0 +1,171 @@
+/*****************************************************************//**
+ * @file task_sched.cpp
+ *
+ * @brief implementation of TaskScheduler class
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "task_sched.h"
+
+TaskScheduler::TaskScheduler() {
+   num = 0;
+}
+
+TaskScheduler::~TaskScheduler() {
+}
+
+// insert task in priority order (stable for equal priority)
+int TaskScheduler::add(TaskFunc func, void *arg, int prio,
+      uint32_t period_us, uint32_t budget_us) {
+   int i;
+
+   if (num >= MAX_TASKS)
+      return (-1);
+   // period/budget are kept in 32-bit ticks
+   if (period_us > (uint32_t) MAX_TIME_US || budget_us > (uint32_t) MAX_TIME_US)
+      return (-1);
+   i = num;
+   while (i > 0 && task[i - 1].prio > prio) {
+      task[i] = task[i - 1];
+      i--;
+   }
+   task[i].func = func;
+   task[i].arg = arg;
+   task[i].id = num;
+   task[i].prio = prio;
+   task[i].ready = 0;
+   task[i].release = now_tick();
+   task[i].period = period_us * SYS_CLK_FREQ;
+   task[i].budget = budget_us * SYS_CLK_FREQ;
+   task[i].wcet = 0;
+   task[i].latency = 0;
+   task[i].overrun = 0;
+   task[i].over_max = 0;
+   num++;
+   return (num - 1);
+}
+
+int TaskScheduler::add_periodic(TaskFunc func, void *arg, int prio,
+      uint32_t period_us, uint32_t budget_us) {
+   if (period_us == 0)
+      return (-1);
+   return (add(func, arg, prio, period_us, budget_us));
+}
+
+int TaskScheduler::add_event(TaskFunc func, void *arg, int prio,
+      uint32_t budget_us) {
+   return (add(func, arg, prio, 0, budget_us));
+}
+
+TaskScheduler::Task *TaskScheduler::find(int id) {
+   int i;
+
+   for (i = 0; i < num; i++) {
+      if (task[i].id == id)
+         return (&task[i]);
+   }
+   return (0);
+}
+
+void TaskScheduler::signal(int id) {
+   Task *t = find(id);
+
+   if (t)
+      t->ready = 1;
+}
+
+int TaskScheduler::run_once() {
+   uint64_t now, start, late;
+   uint32_t exec;
+   Task *t = 0;
+   int i;
+
+   now = now_tick();
+   // table is sorted: first ready task has the highest priority
+   for (i = 0; i < num; i++) {
+      if (task[i].period) {
+         if ((int64_t) (now - task[i].release) >= 0) {
+            t = &task[i];
+            break;
+         }
+      } else if (task[i].ready) {
+         t = &task[i];
+         break;
+      }
+   }
+   if (t == 0)
+      return (-1);
+   if (t->period) {
+      late = now - t->release;
+      if (late > t->latency)
+         t->latency = (uint32_t) late;
+      // drift-free release; skip releases missed by a long overrun
+      t->release = t->release + t->period;
+      if ((int64_t) (now - t->release) >= 0)
+         t->release = now + t->period;
+   } else {
+      t->ready = 0;
+   }
+   start = now_tick();
+   t->func(t->arg);
+   exec = (uint32_t) (now_tick() - start);
+   if (exec > t->wcet)
+      t->wcet = exec;
+   // record only; printing here would delay every other task
+   if (t->budget && exec > t->budget) {
+      t->overrun++;
+      if (exec > t->over_max)
+         t->over_max = exec;
+   }
+   return (t->id);
+}
+
+void TaskScheduler::run() {
+   while (1) {
+      run_once();
+   }
+}
+
+uint32_t TaskScheduler::wcet_us(int id) {
+   Task *t = find(id);
+
+   return (t ? (uint32_t) TimerCore::tick2us(t->wcet) : 0);
+}
+
+uint32_t TaskScheduler::latency_us(int id) {
+   Task *t = find(id);
+
+   return (t ? (uint32_t) TimerCore::tick2us(t->latency) : 0);
+}
+
+int TaskScheduler::overruns(int id) {
+   Task *t = find(id);
+
+   return (t ? t->overrun : 0);
+}
+
+uint32_t TaskScheduler::overrun_max_us(int id) {
+   Task *t = find(id);
+
+   return (t ? (uint32_t) TimerCore::tick2us(t->over_max) : 0);
+}
+
+void TaskScheduler::report() {
+   int id;
+
+   for (id = 0; id < num; id++) {
+      uart.disp("task ");
+      uart.disp(id);
+      uart.disp(" wcet/latency (us): ");
+      uart.disp((int) wcet_us(id));
+      uart.disp(" / ");
+      uart.disp((int) latency_us(id));
+      uart.disp(", overruns: ");
+      uart.disp(overruns(id));
+      uart.disp(" (max us: ");
+      uart.disp((int) overrun_max_us(id));
+      uart.disp(")\n\r");
+   }
+}
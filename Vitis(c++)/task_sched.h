@@ -0,0 +1,159 @@
+/*****************************************************************//**
+ * @file task_sched.h
+ *
+ * @brief Cooperative run-to-completion task scheduler
+ *
+ * Description:
+ *  - fixed-priority periodic and event-triggered tasks
+ *  - a task is a function that returns quickly (no busy waiting)
+ *  - run_once() runs the highest-priority ready task to completion
+ *  - execution time of each run measured with the system timer;
+ *    worst case kept per task; budget overruns counted (no output in
+ *    the dispatch path; print them with report() from a task)
+ *  - static task table; no heap is used
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TASK_SCHED_H_INCLUDED
+#define _TASK_SCHED_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * task function type
+ * @param arg user argument given when the task was added
+ */
+typedef void (*TaskFunc)(void *arg);
+
+/**
+ * cooperative task scheduler
+ *  - lower priority value runs first; equal priority in order added
+ *  - periodic task released every period_us (drift-free)
+ *  - event task released by signal()
+ */
+class TaskScheduler {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      MAX_TASKS = 8, /**< size of the task table */
+      MAX_TIME_US = (int) (0xffffffffUL / SYS_CLK_FREQ) /**< max period/budget (32-bit ticks) */
+   };
+
+   /**
+    * constructor
+    */
+   TaskScheduler();
+   ~TaskScheduler();  // not used
+
+   /**
+    * add a periodic task
+    *
+    * @param func task function
+    * @param arg argument passed to func
+    * @param prio priority (0 is highest)
+    * @param period_us release period in microsecond
+    * @param budget_us execution time budget in microsecond (0: no check)
+    * @return task id; -1 if the table is full or a time exceeds MAX_TIME_US
+    *
+    * @note first release is immediate
+    */
+   int add_periodic(TaskFunc func, void *arg, int prio, uint32_t period_us,
+         uint32_t budget_us);
+
+   /**
+    * add an event-triggered task
+    *
+    * @param func task function
+    * @param arg argument passed to func
+    * @param prio priority (0 is highest)
+    * @param budget_us execution time budget in microsecond (0: no check)
+    * @return task id; -1 if the table is full or budget exceeds MAX_TIME_US
+    */
+   int add_event(TaskFunc func, void *arg, int prio, uint32_t budget_us);
+
+   /**
+    * release an event task (may be called from a running task)
+    *
+    * @param id task id
+    */
+   void signal(int id);
+
+   /**
+    * run the highest-priority ready task once
+    *
+    * @return id of the task run; -1 if no task was ready
+    */
+   int run_once();
+
+   /**
+    * run tasks forever
+    *
+    */
+   void run();
+
+   /**
+    * worst-case execution time of a task
+    *
+    * @param id task id
+    * @return longest run in microsecond
+    */
+   uint32_t wcet_us(int id);
+
+   /**
+    * worst-case release-to-start latency of a task
+    *
+    * @param id task id
+    * @return longest delay in microsecond (periodic tasks only)
+    */
+   uint32_t latency_us(int id);
+
+   /**
+    * # runs that exceeded the budget
+    *
+    * @param id task id
+    */
+   int overruns(int id);
+
+   /**
+    * longest run that exceeded the budget
+    *
+    * @param id task id
+    * @return execution time in microsecond (0: no overrun)
+    */
+   uint32_t overrun_max_us(int id);
+
+   /**
+    * print wcet/latency/overrun table via "uart"
+    *
+    * @note blocking unless uart tx is buffered; call it from a
+    *       low-priority task or outside the scheduler
+    */
+   void report();
+
+private:
+   struct Task {
+      TaskFunc func;
+      void *arg;
+      int id;
+      int prio;
+      int ready;            // event task released
+      uint64_t release;     // next release (ticks); periodic only
+      uint32_t period;      // ticks; 0 for event task
+      uint32_t budget;      // ticks; 0 for no check
+      uint32_t wcet;        // ticks
+      uint32_t latency;     // ticks
+      int overrun;
+      uint32_t over_max;    // ticks; longest overrunning run
+   };
+   Task task[MAX_TASKS];   // sorted by priority
+   int num;
+   int add(TaskFunc func, void *arg, int prio, uint32_t period_us,
+         uint32_t budget_us);
+   Task *find(int id);
+};
+
+#endif  // _TASK_SCHED_H_INCLUDED
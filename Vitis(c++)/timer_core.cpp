@@ -40,25 +40,65 @@ void TimerCore::clear() {
    io_write(base_addr, CTRL_REG, wdata);
 }
 
+/* reciprocals for divide-free conversion; ceil(2^64/d) */
+static const uint64_t US_RECIP = 0xffffffffffffffffULL / SYS_CLK_FREQ + 1;
+static const uint64_t MS_RECIP = 0xffffffffffffffffULL / 1000 + 1;
+
+/* upper 64 bits of the 128-bit product a*b using 32-bit partial products */
+static uint64_t mul_hi64(uint64_t a, uint64_t b) {
+   uint64_t a_lo, a_hi, b_lo, b_hi;
+   uint64_t lo_lo, hi_lo, lo_hi, cross;
+
+   a_lo = (uint32_t) a;
+   a_hi = a >> 32;
+   b_lo = (uint32_t) b;
+   b_hi = b >> 32;
+   lo_lo = a_lo * b_lo;
+   hi_lo = a_hi * b_lo;
+   lo_hi = a_lo * b_hi;
+   cross = (lo_lo >> 32) + (uint32_t) hi_lo + lo_hi;
+   return (a_hi * b_hi + (hi_lo >> 32) + (cross >> 32));
+}
+
+uint64_t TimerCore::tick2us(uint64_t tick) {
+   return (mul_hi64(tick, US_RECIP));
+}
+
+uint64_t TimerCore::tick2ms(uint64_t tick) {
+   return (mul_hi64(mul_hi64(tick, US_RECIP), MS_RECIP));
+}
+
 uint64_t TimerCore::read_tick() {
-   uint64_t upper, lower;
+   uint32_t upper, lower;
+
+   // retry if the upper word changed while the lower word was read
+   do {
+      upper = io_read(base_addr, COUNTER_UPPER_REG);
+      lower = io_read(base_addr, COUNTER_LOWER_REG);
+   } while (upper != io_read(base_addr, COUNTER_UPPER_REG));
+   return (((uint64_t) upper << 32) | lower);
+}
 
-   lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
-   upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
-   return ((upper << 32) | lower);
+uint32_t TimerCore::read_tick_lo() {
+   return (io_read(base_addr, COUNTER_LOWER_REG));
 }
 
 uint64_t TimerCore::read_time() {
    // elapsed time in microsecond (SYS_CLK_FREQ in MHz)
-   return (read_tick() / SYS_CLK_FREQ);
+   return (tick2us(read_tick()));
+}
+
+uint64_t TimerCore::read_time_ms() {
+   return (tick2ms(read_tick()));
 }
 
 void TimerCore::sleep(uint64_t us) {
-   uint64_t start_time, now;
+   uint64_t start_tick, ticks;
 
-   start_time = read_time();
+   // compare raw ticks; no conversion inside the loop
+   ticks = us * SYS_CLK_FREQ;
+   start_tick = read_tick();
    // busy waiting
-   do {
-      now = read_time();
-   } while ((now - start_time) < us);
+   while ((read_tick() - start_tick) < ticks)
+      ;
 }
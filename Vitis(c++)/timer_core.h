@@ -69,9 +69,21 @@ public:
    /**
     * read current timing counter value (# clocks elapsed from last clear)
     *
+    * @note upper word re-read (hi-lo-hi) so a lower-word wrap between
+    *       the two accesses cannot tear the 48-bit value
+    *
     */
    uint64_t read_tick();
 
+   /**
+    * read lower 32 bits of the timing counter
+    *
+    * @note single access; wraps every 2^32 clocks, so use only
+    *       for short wrap-safe intervals (e.g., now - start)
+    *
+    */
+   uint32_t read_tick_lo();
+
    /**
     * read current time (microseconds elapsed from last clear)
     *
@@ -80,6 +92,29 @@ public:
     */
    uint64_t read_time();
 
+   /**
+    * read current time (milliseconds elapsed from last clear)
+    *
+    */
+   uint64_t read_time_ms();
+
+   /**
+    * convert clock ticks to microseconds without a divide
+    *
+    * @param tick # clocks (less than 2^64/SYS_CLK_FREQ)
+    * @note multiply by ceil(2^64/SYS_CLK_FREQ), keep upper 64 bits
+    *
+    */
+   static uint64_t tick2us(uint64_t tick);
+
+   /**
+    * convert clock ticks to milliseconds without a divide
+    *
+    * @param tick # clocks
+    *
+    */
+   static uint64_t tick2ms(uint64_t tick);
+
    /**
     * idle (busy waiting) for us microsecond
     *
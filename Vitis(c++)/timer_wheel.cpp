@@ -0,0 +1,167 @@
+/*****************************************************************//**
+ * @file timer_wheel.cpp
+ *
+ * @brief implementation of SwTimer and TimerWheel classes
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "timer_wheel.h"
+
+/* wrap-safe check: deadline at or before now */
+static int time_due(uint64_t due_us, uint64_t now) {
+   return ((int64_t) (due_us - now) <= 0);
+}
+
+/* current up time in microsecond (64-bit; does not wrap) */
+static uint64_t now_us64() {
+   return (TimerCore::tick2us(now_tick()));
+}
+
+/**********************************************************************
+ * SwTimer
+ **********************************************************************/
+SwTimer::SwTimer() {
+   link.next = 0;
+   link.prev = 0;
+   due_us = 0;
+   period_us = 0;
+   func = 0;
+   arg = 0;
+   on = 0;
+}
+
+int SwTimer::active() {
+   return (on);
+}
+
+uint64_t SwTimer::deadline() {
+   return (due_us);
+}
+
+/**********************************************************************
+ * TimerWheel
+ **********************************************************************/
+TimerWheel::TimerWheel() {
+   int i;
+
+   // each slot is a circular list with itself as the head
+   for (i = 0; i < WHEEL_SIZE; i++) {
+      slot[i].next = &slot[i];
+      slot[i].prev = &slot[i];
+   }
+   // no timer access here (global instances may be constructed before
+   // _sys_timer); the first poll() visits every slot once
+   cur_tick = 0;
+   num = 0;
+}
+
+TimerWheel::~TimerWheel() {
+}
+
+// put t at the tail of the slot of its deadline tick
+// (a past deadline goes to the current slot, which every poll visits)
+void TimerWheel::insert(SwTimer *t) {
+   uint64_t tick;
+   SwTimerLink *head;
+
+   tick = t->due_us >> TICK_SHIFT;
+   if ((int64_t) (tick - cur_tick) < 0)
+      tick = cur_tick;
+   head = &slot[tick & WHEEL_MASK];
+   t->link.next = head;
+   t->link.prev = head->prev;
+   head->prev->next = &t->link;
+   head->prev = &t->link;
+   t->on = 1;
+   num++;
+}
+
+void TimerWheel::unlink(SwTimer *t) {
+   t->link.prev->next = t->link.next;
+   t->link.next->prev = t->link.prev;
+   t->link.next = 0;
+   t->link.prev = 0;
+   t->on = 0;
+   num--;
+}
+
+void TimerWheel::start(SwTimer *t, uint32_t delay_us, uint32_t period_us,
+      SwTimerFunc func, void *arg) {
+   if (t->on)
+      unlink(t);
+   t->due_us = now_us64() + delay_us;
+   t->period_us = period_us;
+   t->func = func;
+   t->arg = arg;
+   insert(t);
+}
+
+void TimerWheel::cancel(SwTimer *t) {
+   if (t->on)
+      unlink(t);
+}
+
+int TimerWheel::pending() {
+   return (num);
+}
+
+int TimerWheel::poll() {
+   return (poll(now_us64()));
+}
+
+/* procedure:
+ *    1. visit the slots of ticks cur_tick .. now (at most one revolution)
+ *    2. move due timers of a slot to a local expired list
+ *    3. pop expired timers one by one; re-arm periodic ones and
+ *       invoke the callback (callbacks may start/cancel any timer)
+ *    4. keep cur_tick at the current tick; its slot may still
+ *       hold timers due later within the same tick
+ */
+int TimerWheel::poll(uint64_t now) {
+   uint64_t now_tick, n, k;
+   SwTimerLink expired, *head, *p, *nxt;
+   SwTimer *t;
+   int fired = 0;
+
+   now_tick = now >> TICK_SHIFT;
+   if ((int64_t) (now_tick - cur_tick) < 0)
+      return (0);
+   n = now_tick - cur_tick + 1;
+   if (n > WHEEL_SIZE)
+      n = WHEEL_SIZE;     // long gap: every slot visited once
+   for (k = 0; k < n; k++) {
+      head = &slot[(cur_tick + k) & WHEEL_MASK];
+      if (head->next == head)
+         continue;
+      expired.next = &expired;
+      expired.prev = &expired;
+      for (p = head->next; p != head; p = nxt) {
+         nxt = p->next;
+         t = (SwTimer *) p;
+         if (time_due(t->due_us, now)) {
+            p->prev->next = p->next;
+            p->next->prev = p->prev;
+            p->next = &expired;
+            p->prev = expired.prev;
+            expired.prev->next = p;
+            expired.prev = p;
+         }
+      }
+      while (expired.next != &expired) {
+         t = (SwTimer *) expired.next;
+         unlink(t);
+         if (t->period_us) {
+            t->due_us = t->due_us + t->period_us;
+            if (time_due(t->due_us, now))
+               t->due_us = now + t->period_us;   // overrun: skip missed
+            insert(t);
+         }
+         t->func(t->arg);
+         fired++;
+      }
+   }
+   cur_tick = now_tick;
+   return (fired);
+}
@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * @file timer_wheel.h
+ *
+ * @brief Deadline-based software timers on top of the system timer
+ *
+ * Description:
+ *  - hashed timer wheel driven by the 64-bit microsecond up time
+ *  - one-shot and periodic callbacks
+ *  - O(1) start/cancel; poll() only visits the slots of elapsed ticks
+ *  - timer storage (SwTimer) is owned by the caller; no heap is used
+ *  - callbacks run from poll() in the main loop (not in an interrupt)
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TIMER_WHEEL_H_INCLUDED
+#define _TIMER_WHEEL_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * callback type of a software timer
+ * @param arg user argument given in TimerWheel::start()
+ */
+typedef void (*SwTimerFunc)(void *arg);
+
+/**
+ * doubly-linked list node of a wheel slot
+ */
+struct SwTimerLink {
+   SwTimerLink *next;
+   SwTimerLink *prev;
+};
+
+/**
+ * software timer
+ *  - allocated by the caller (static or global) and passed to TimerWheel
+ *  - fields are managed by TimerWheel
+ */
+class SwTimer {
+public:
+   SwTimer();
+
+   /**
+    * check whether the timer is pending
+    *
+    * @return 1: pending; 0: idle (expired one-shot or canceled)
+    */
+   int active();
+
+   /**
+    * deadline of the next expiration (microsecond up time)
+    */
+   uint64_t deadline();
+
+private:
+   friend class TimerWheel;
+   SwTimerLink link;   // must be first; slot lists link through it
+   uint64_t due_us;    // absolute deadline
+   uint32_t period_us; // 0 for one-shot
+   SwTimerFunc func;
+   void *arg;
+   int on;
+};
+
+/**
+ * hashed timer wheel
+ *  - a tick is 2^TICK_SHIFT us (1.024 ms); deadline tick hashes to a slot
+ *  - timers beyond one revolution stay in their slot for later rounds
+ *  - deadlines compared with wrap-safe 64-bit differences
+ */
+class TimerWheel {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      TICK_SHIFT = 10,                /**< tick = 1024 us */
+      WHEEL_BITS = 8,
+      WHEEL_SIZE = 1 << WHEEL_BITS,   /**< # slots (one revolution ~262 ms) */
+      WHEEL_MASK = WHEEL_SIZE - 1
+   };
+
+   /**
+    * constructor
+    *
+    * @note wheel starts at the current up time
+    */
+   TimerWheel();
+   ~TimerWheel();
+
+   /**
+    * start (or restart) a timer
+    *
+    * @param t pointer to caller-owned timer
+    * @param delay_us delay until first expiration (microsecond)
+    * @param period_us period for repeat; 0 for one-shot
+    * @param func callback
+    * @param arg argument passed to callback
+    *
+    */
+   void start(SwTimer *t, uint32_t delay_us, uint32_t period_us,
+         SwTimerFunc func, void *arg);
+
+   /**
+    * cancel a pending timer (no effect if idle)
+    *
+    * @param t pointer to timer
+    *
+    */
+   void cancel(SwTimer *t);
+
+   /**
+    * fire all timers whose deadline has passed
+    *
+    * @return # callbacks invoked
+    * @note call from the main loop as often as timer resolution requires
+    */
+   int poll();
+
+   /**
+    * fire all timers due at a given time
+    *
+    * @param now current up time in microsecond
+    * @return # callbacks invoked
+    */
+   int poll(uint64_t now);
+
+   /**
+    * # pending timers
+    */
+   int pending();
+
+private:
+   SwTimerLink slot[WHEEL_SIZE];
+   uint64_t cur_tick;   // oldest tick whose slot may still hold due timers
+   int num;
+   void insert(SwTimer *t);
+   void unlink(SwTimer *t);
+};
+
+#endif  // _TIMER_WHEEL_H_INCLUDED
@@ -8,9 +8,16 @@
  ********************************************************************/
 
 #include "uart_core.h"
+#include "chu_init.h"   // to use now_tick_lo()
+#include "num_fmt.h"
 
 UartCore::UartCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   tx_head = 0;
+   tx_tail = 0;
+   tx_mode = TX_UNBUFFERED;
+   dropped = 0;
+   peak = 0;
    set_baud_rate(9600);      //default baud rate
 }
 
@@ -23,6 +30,13 @@ void UartCore::set_baud_rate(int baud) {
 
    dvsr = SYS_CLK_FREQ*1000000 / 16 / baud - 1;
    io_write(base_addr, DVSR_REG, dvsr);
+   // 10-bit frame is 160*(dvsr+1) ticks; assume 11 bits for margin
+   tx_byte_ticks = 176 * (dvsr + 1);
+   // floor(2^32/tx_byte_ticks): tx_credit() divides by multiply
+   tx_byte_recip = (uint32_t) (0xffffffffULL / tx_byte_ticks);
+   tx_bound = TX_FIFO_DEPTH;   // fifo content unknown
+   tx_anchor = now_tick_lo();
+   tx_stale = 0;
 }
 
 int UartCore::rx_fifo_empty() {
@@ -47,6 +61,7 @@ void UartCore::tx_byte(uint8_t byte) {
    while (tx_fifo_full()) {
    };  // busy waiting
    io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
+   tx_stale = 1;   // write time not recorded; bound must restart
 }
 
 int UartCore::rx_byte() {
@@ -61,61 +76,174 @@ int UartCore::rx_byte() {
    }
 }
 
+/*
+ * # bytes the tx fifo can surely take without a status read
+ *  - tx_bound: fifo occupancy bound at tx_anchor
+ *  - a byte written by tx_byte() has no time stamp, so the bound
+ *    restarts at full (tx_stale); so does a timer that went backward
+ *  - one byte leaves the fifo at least every tx_byte_ticks;
+ *    elapsed/tx_byte_ticks by reciprocal multiply (no divider on the
+ *    mcs); the result may be one low, which keeps the bound safe
+ *  - lower timer word only; an interval misread after a wrap is
+ *    shorter, so the bound stays conservative
+ */
+int UartCore::tx_credit() {
+   uint32_t now, elapsed, drained;
+
+   now = now_tick_lo();
+   elapsed = now - tx_anchor;
+   if (tx_stale || (int32_t) elapsed < 0) {
+      tx_bound = TX_FIFO_DEPTH;
+      tx_anchor = now;
+      tx_stale = 0;
+      return (0);
+   }
+   drained = (uint32_t) (((uint64_t) elapsed * tx_byte_recip) >> 32);
+   if (drained >= (uint32_t) tx_bound) {
+      tx_bound = 0;
+      tx_anchor = now;
+   } else if (drained) {
+      tx_bound = tx_bound - (int) drained;
+      tx_anchor = tx_anchor + drained * tx_byte_ticks;
+   }
+   return (TX_FIFO_DEPTH - tx_bound);
+}
+
+void UartCore::write(const uint8_t *data, int n) {
+   int credit;
+
+   while (n > 0) {
+      credit = tx_credit();
+      if (credit == 0) {
+         if (io_read(base_addr, RD_DATA_REG) & TX_FULL_FIELD) {
+            tx_bound = TX_FIFO_DEPTH;  // observed full; restart decay
+            tx_anchor = now_tick_lo();
+            continue;                  // busy waiting
+         }
+         tx_bound = TX_FIFO_DEPTH - 1;
+         credit = 1;
+      }
+      if (credit > n)
+         credit = n;
+      n = n - credit;
+      tx_bound = tx_bound + credit;
+      while (credit) {
+         io_write(base_addr, WR_DATA_REG, (uint32_t) *data);
+         data++;
+         credit--;
+      }
+   }
+}
+
+int UartCore::read(uint8_t *buf, int max) {
+   uint32_t rd_word;
+   int n = 0;
+
+   while (n < max) {
+      rd_word = io_read(base_addr, RD_DATA_REG);
+      if (rd_word & RX_EMPT_FIELD)
+         break;
+      buf[n] = (uint8_t) (rd_word & RX_DATA_FIELD);
+      io_write(base_addr, RM_RD_DATA_REG, 0);  // remove data from rx FIFO
+      n++;
+   }
+   return (n);
+}
+
+void UartCore::set_tx_mode(int mode) {
+   if (mode == TX_UNBUFFERED)
+      tx_flush();
+   tx_mode = mode;
+}
+
+int UartCore::pump() {
+   int n, credit;
+
+   if (tx_tail == tx_head)
+      return (0);
+   credit = tx_credit();
+   if (credit == 0) {
+      if (io_read(base_addr, RD_DATA_REG) & TX_FULL_FIELD) {
+         tx_bound = TX_FIFO_DEPTH;
+         tx_anchor = now_tick_lo();
+         return (0);
+      }
+      tx_bound = TX_FIFO_DEPTH - 1;
+      credit = 1;
+   }
+   n = 0;
+   while (tx_tail != tx_head && n < credit) {
+      io_write(base_addr, WR_DATA_REG,
+            (uint32_t) tx_buf[tx_tail & (TX_BUF_SIZE - 1)]);
+      tx_tail++;
+      n++;
+   }
+   tx_bound = tx_bound + n;
+   return (n);
+}
+
+void UartCore::tx_flush() {
+   while (tx_tail != tx_head) {
+      pump();
+   }
+}
+
+int UartCore::tx_pending() {
+   return ((int) (tx_head - tx_tail));
+}
+
+uint32_t UartCore::tx_dropped() {
+   return (dropped);
+}
+
+int UartCore::tx_peak() {
+   return (peak);
+}
+
+/* route a display byte according to tx mode */
+void UartCore::put(uint8_t byte) {
+   int n;
+
+   if (tx_mode == TX_UNBUFFERED) {
+      tx_byte(byte);
+      return;
+   }
+   if (tx_head - tx_tail == TX_BUF_SIZE) {
+      if (tx_mode == TX_DROP) {
+         dropped++;
+         return;
+      } else if (tx_mode == TX_OVERWRITE) {
+         tx_tail++;            // discard oldest
+         dropped++;
+      } else {
+         while (pump() == 0 && tx_head - tx_tail == TX_BUF_SIZE) {
+         }
+      }
+   }
+   tx_buf[tx_head & (TX_BUF_SIZE - 1)] = byte;
+   tx_head++;
+   n = (int) (tx_head - tx_tail);
+   if (n > peak)
+      peak = n;
+}
+
 void UartCore::disp(const char *str) {
    disp_str(str);
 }
 
 void UartCore::disp(char ch) {
-    tx_byte(ch);
+   if (tx_mode == TX_UNBUFFERED) {
+      write((const uint8_t *) &ch, 1);
+      return;
+   }
+   put(ch);
+   pump();
 }
 
 void UartCore::disp(int n, int base, int len) {
-   char buf[33];         // 32 bit #
-   char *str, ch, sign;
-   int rem, i;
-   unsigned int un;
-
-   /* error check */
-   if (base != 2 && base != 8 && base != 16)
-      base = 10;
-   if (len > 32)
-      len = 32;
-   /* handle neg decimal # */
-   if (base == 10 && n < 0) {
-      un = (unsigned) -n;
-      sign = '-';
-   } else {
-      un = (unsigned) n; // interpreted as unsigned for hex/bin conversion
-      sign = ' ';
-   }
-   /* convert # to string */
-   str = &buf[33];
-   *str = '\0';
-   i = 0;
-   do {
-      str--;
-      rem = un % base;
-      un = un / base;
-      if (rem < 10)
-         ch = (char) rem + '0';
-      else
-         ch = (char) rem - 10 + 'a';
-      *str = ch;
-      i++;
-   } while (un);
-   /* attach - sign for neg decimal # */
-   if (sign == '-') {
-      str--;
-      *str = sign;
-      i++;
-   }
-   /* pad with blank */
-   while (i < len) {
-      str--;
-      *str = ' ';
-      i++;
-   };
-   disp_str(str);
+   char buf[FMT_INT_SIZE];
+
+   disp_str(fmt_int(buf, n, base, len));
 }
 
 void UartCore::disp(int n) {
@@ -127,26 +255,15 @@ void UartCore::disp(int n, int base) {
 }
 
 void UartCore::disp(double f, int digit) {
-   double fa, frac; // absolute value of f
-   int n, i, i_part;
+   char buf[FMT_FIXED_SIZE];
 
-   fa = f;
-   if (f < 0.0) {
-      fa = -f;
-      disp_str("-");
-   }
-   // display integer portion
-   i_part = (int) fa; // integer part of f
-   disp(i_part);
-   disp_str(".");
-   // display fraction part
-   frac = fa - (double) i_part;
-   for (n = 0; n < digit; n++) {
-      frac = frac * 10.0;
-      i = (int) frac;
-      disp(i);
-      frac = frac - i;
-   }
+   disp_str(fmt_double(buf, f, digit));
+}
+
+void UartCore::disp_fixed(int32_t q, int frac_bits, int digit) {
+   char buf[FMT_FIXED_SIZE];
+
+   disp_str(fmt_fixed(buf, q, frac_bits, digit));
 }
 
 void UartCore::disp(double f) {
@@ -154,10 +271,40 @@ void UartCore::disp(double f) {
 }
 
 void UartCore::disp_str(const char *str) {
+   const char *end;
+
+   if (tx_mode == TX_UNBUFFERED) {
+      for (end = str; *end; end++) {
+      }
+      write((const uint8_t *) str, (int) (end - str));
+      return;
+   }
    while ((uint8_t) *str) {
-      tx_byte(*str);
+      put(*str);
       str++;
    }
+   pump();  // opportunistic; never waits
+}
+
+#ifdef __cpp_impl_coroutine
+UartTxOp UartCore::tx_byte_async(uint8_t byte) {
+   return (UartTxOp(this, byte));
 }
 
+UartTxOp::UartTxOp(UartCore *core, uint8_t byte) {
+   uart = core;
+   data = byte;
+   done = 0;
+}
 
+int UartTxOp::poll() {
+   if (!done) {
+      if (uart->tx_fifo_full())
+         return (0);
+      io_write(uart->base_addr, UartCore::WR_DATA_REG, (uint32_t) data);
+      uart->tx_stale = 1;
+      done = 1;
+   }
+   return (1);
+}
+#endif  // __cpp_impl_coroutine
@@ -13,10 +13,32 @@
 
 #include "chu_io_rw.h"
 #include "chu_io_map.h"  // to use SYS_CLK_FREQ
+#include "async_io.h"
+
+#ifdef __cpp_impl_coroutine
+class UartCore;
+
+/**
+ * awaitable uart transmission of a byte (see UartCore::tx_byte_async())
+ */
+class UartTxOp: public AsyncOp {
+public:
+   UartTxOp(UartCore *core, uint8_t byte);
+   int poll();
+   void await_resume() {
+   }
+private:
+   UartCore *uart;
+   uint8_t data;
+   int done;
+};
+#endif
 /**
  * uart core driver
  * - transmit/receive data via MMIO uart core.
  * - display (print) number and string on serial console
+ * - optional software tx ring buffer so disp() does not wait for
+ *   the hardware tx fifo (see set_tx_mode())
  *
  */
 class UartCore {
@@ -39,7 +61,31 @@ class UartCore {
       RX_EMPT_FIELD = 0x00000100, /**< bit 10 of rd_data_reg; empty bit */
       RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
    };
+   /**
+    * hardware parameter
+    *
+    */
+   enum {
+      TX_FIFO_DEPTH = 256  /**< FIFO_DEPTH_BIT(8) in mmio_sys_sampler.sv */
+   };
 public:
+   /**
+    * tx buffer mode / overflow policy
+    *
+    */
+   enum {
+      TX_UNBUFFERED = 0, /**< disp() busy waits on tx fifo (default) */
+      TX_DROP = 1,       /**< buffered; new bytes dropped when ring full */
+      TX_BLOCK = 2,      /**< buffered; pump until ring has space */
+      TX_OVERWRITE = 3   /**< buffered; oldest bytes discarded when ring full */
+   };
+   /**
+    * symbolic constant
+    *
+    */
+   enum {
+      TX_BUF_SIZE = 256  /**< tx ring size (power of 2) */
+   };
    /* methods */
    /**
     * constructor.
@@ -92,6 +138,84 @@ public:
     */
    int rx_byte();
 
+   /**
+    * transmit a block of bytes
+    *
+    * @param data pointer to data bytes
+    * @param n # bytes
+    *
+    * @note "busy waits" like tx_byte() when the tx fifo is full
+    * @note the status register is read only when the known free
+    *       fifo space runs out (see tx_credit())
+    */
+   void write(const uint8_t *data, int n);
+
+   /**
+    * receive available bytes
+    *
+    * @param buf pointer to the receive buffer
+    * @param max buffer size
+    * @return # bytes received (0 if rx fifo empty)
+    *
+    * @note the function does not "busy wait"
+    * @note one status/data read and one remove write per byte
+    */
+   int read(uint8_t *buf, int max);
+
+   /**
+    * select tx buffer mode
+    *
+    * @param mode TX_UNBUFFERED, TX_DROP, TX_BLOCK or TX_OVERWRITE
+    *
+    * @note switching to TX_UNBUFFERED first drains the ring (blocking)
+    */
+   void set_tx_mode(int mode);
+
+   /**
+    * move buffered bytes into the tx fifo until it is full
+    *
+    * @return # bytes moved
+    *
+    * @note non-blocking; call from the main loop in buffered modes
+    */
+   int pump();
+
+   /**
+    * wait until all buffered bytes are in the tx fifo
+    *
+    */
+   void tx_flush();
+
+   /**
+    * # bytes waiting in the tx ring
+    *
+    */
+   int tx_pending();
+
+   /**
+    * # bytes lost to the overflow policy (drop/overwrite)
+    *
+    */
+   uint32_t tx_dropped();
+
+   /**
+    * highest tx ring occupancy seen
+    *
+    */
+   int tx_peak();
+
+#ifdef __cpp_impl_coroutine
+   /**
+    * non-blocking version of tx_byte() for an AsyncTask
+    *
+    * @param byte data byte to be transmitted
+    * @return awaitable op; the task is parked while tx fifo is full
+    *
+    * @note usage: co_await uart.tx_byte_async(ch);
+    */
+   UartTxOp tx_byte_async(uint8_t byte);
+#endif
+
    /**
     * display (print) a char on a serial terminal console
     *
@@ -150,6 +274,7 @@ public:
     * @param digit # of digits (length) in fraction portion to be displayed
     * @note base 10 used
     * @note length in integer determined automatically
+    * @note fraction converted via 28-bit fixed point (max 18 digits)
     *
     */
    void disp(double f, int digit);
@@ -165,9 +290,39 @@ public:
     */
    void disp(double f);
 
+   /**
+    * display (print) a Q-format fixed-point number on a serial terminal console
+    *
+    * @param q fixed-point value (value = q / 2^frac_bits)
+    * @param frac_bits # fraction bits (max 28)
+    * @param digit # of digits in fraction portion (truncated, max 18)
+    * @note base 10 used; no floating-point operation
+    * @note e.g., adt7420 reading (1/16 C per lsb): disp_fixed(raw, 4, 2)
+    *
+    */
+   void disp_fixed(int32_t q, int frac_bits, int digit);
+
 private:
+#ifdef __cpp_impl_coroutine
+   friend class UartTxOp;
+#endif
    uint32_t base_addr;
    int baud_rate;
+   /* tx ring; head/tail free running, index = count & (TX_BUF_SIZE-1) */
+   uint8_t tx_buf[TX_BUF_SIZE];
+   uint32_t tx_head;
+   uint32_t tx_tail;
+   int tx_mode;
+   uint32_t dropped;
+   int peak;
+   /* upper bound of tx fifo occupancy, decayed by elapsed byte times */
+   int tx_bound;
+   uint32_t tx_anchor;      // tick (lower word) when tx_bound was valid
+   uint32_t tx_byte_ticks;  // ticks per byte, with margin
+   uint32_t tx_byte_recip;  // 2^32 / tx_byte_ticks (rounded down)
+   int tx_stale;            // bytes written without updating tx_bound
+   int tx_credit();
+   void put(uint8_t byte);
    void disp_str(const char *str);
 };
 
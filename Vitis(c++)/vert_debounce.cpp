@@ -0,0 +1,67 @@
+/*****************************************************************//**
+ * @file vert_debounce.cpp
+ *
+ * @brief implementation of the vertical-counter debouncer
+ *
+ * @author agent
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "vert_debounce.h"
+
+VertDebounce::VertDebounce() {
+   init(0, 4);
+}
+
+VertDebounce::~VertDebounce() {
+}
+
+/*
+ * a counter starts at MAX_SAMPLES - n and a change is accepted when it
+ * reaches MAX_SAMPLES (all bit planes 1), i.e., after n increments
+ */
+void VertDebounce::init(uint32_t sample, int n) {
+   int i, start;
+
+   if (n < 1)
+      n = 1;
+   if (n > MAX_SAMPLES)
+      n = MAX_SAMPLES;
+   start = MAX_SAMPLES - n;
+   for (i = 0; i < CNT_BITS; i++) {
+      preset[i] = ((start >> i) & 0x01) ? 0xffffffff : 0;
+      cnt[i] = preset[i];
+   }
+   state = sample;
+   toggled = 0;
+}
+
+uint32_t VertDebounce::update(uint32_t raw) {
+   uint32_t delta, carry, full;
+   int i;
+
+   delta = raw ^ state;           // inputs disagreeing with the state
+   carry = delta;
+   full = delta;
+   for (i = 0; i < CNT_BITS; i++) {
+      // restart where the input agrees, then count up where it differs
+      cnt[i] = (cnt[i] & delta) | (preset[i] & ~delta);
+      cnt[i] = cnt[i] ^ carry;
+      carry = carry & ~cnt[i];
+      full = full & cnt[i];
+   }
+   toggled = full;
+   state = state ^ full;
+   // accepted inputs restart from the preset
+   for (i = 0; i < CNT_BITS; i++)
+      cnt[i] = (cnt[i] & ~full) | (preset[i] & full);
+   return (state);
+}
+
+uint32_t VertDebounce::read() {
+   return (state);
+}
+
+uint32_t VertDebounce::changed() {
+   return (toggled);
+}
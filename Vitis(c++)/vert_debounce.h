@@ -0,0 +1,73 @@
+/*****************************************************************//**
+ * @file vert_debounce.h
+ *
+ * @brief Bit-sliced (vertical counter) software debouncer
+ *
+ * Description:
+ *  - filters up to 32 inputs in parallel, one bit per input
+ *  - bit k of the 4 counter words form the counter of input k;
+ *    an update is ~20 word operations regardless of the # inputs
+ *  - an input changes state after n consecutive samples that differ
+ *    from the current state; any agreeing sample restarts the count
+ *  - window = n x sample period; the caller sets the period
+ *    (e.g., GpiCore::set_debounce() samples at a fixed interval)
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _VERT_DEBOUNCE_H_INCLUDED
+#define _VERT_DEBOUNCE_H_INCLUDED
+
+#include "chu_io_rw.h"
+
+/**
+ * vertical-counter debouncer
+ */
+class VertDebounce {
+public:
+   /**
+    * symbolic constant
+    */
+   enum {
+      CNT_BITS = 4,                      /**< counter width (bit planes) */
+      MAX_SAMPLES = (1 << CNT_BITS) - 1  /**< max # samples per window */
+   };
+
+   VertDebounce();
+   ~VertDebounce();  // not used
+
+   /**
+    * set the state and the window without filtering
+    *
+    * @param sample initial debounced state
+    * @param n # consecutive samples to accept a change (1 to MAX_SAMPLES)
+    */
+   void init(uint32_t sample, int n);
+
+   /**
+    * filter one sample of all inputs
+    *
+    * @param raw raw input word
+    * @return debounced state
+    */
+   uint32_t update(uint32_t raw);
+
+   /**
+    * debounced state after the last update()
+    */
+   uint32_t read();
+
+   /**
+    * inputs that changed state in the last update()
+    */
+   uint32_t changed();
+
+private:
+   uint32_t state;             // debounced state
+   uint32_t cnt[CNT_BITS];     // bit plane i: bit i of every counter
+   uint32_t preset[CNT_BITS];  // counter start value (all 0s or all 1s)
+   uint32_t toggled;
+};
+
+#endif  // _VERT_DEBOUNCE_H_INCLUDED
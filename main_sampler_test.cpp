@@ -11,6 +11,10 @@
 #include <ctime>
 #include "chu_init.h"
 #include "gpio_cores.h"
+#include "led_seq.h"
+#include "led_bcm.h"
+#include "pwm_fade.h"
+#include "pwm_dither.h"
 #include "xadc_core.h"
 #include "sseg_core.h"
 #include "spi_core.h"
@@ -18,6 +22,14 @@
 #include "ps2_core.h"
 #include "ddfs_core.h"
 #include "adsr_core.h"
+#include "timer_wheel.h"
+#include "task_sched.h"
+#include "async_io.h"
+#include "num_fmt.h"
+#include "bin_log.h"
+#ifdef _HOST_SIM
+#include "chu_io_sim.h"
+#endif
 
 /**
  * blink once per second for 5 times.
@@ -126,24 +138,167 @@ void adc_check(XadcCore *adc_p, GpoCore *led_p) {
  */
 
 void pwm_3color_led_check(PwmCore *pwm_p) {
-   int i, n;
-   double bright, duty;
-   const double P20 = 1.2589;  // P20=100^(1/20); i.e., P20^20=100
+   PwmFade fade(pwm_p);
+   int n;
 
    pwm_p->set_freq(50);
    for (n = 0; n < 3; n++) {
-      bright = 1.0;
-      for (i = 0; i < 20; i++) {
-         bright = bright * P20;
-         duty = bright / 100.0;
-         pwm_p->set_duty(duty, n);
-         pwm_p->set_duty(duty, n + 3);
-         sleep_ms(100);
-      }
+      fade.fade(n, PwmFade::LEVEL_MAX, 2000);
+      fade.fade(n + 3, PwmFade::LEVEL_MAX, 2000);
+      while (fade.busy(n) || fade.busy(n + 3))
+         fade.poll();
       sleep_ms(300);
-      pwm_p->set_duty(0.0, n);
-      pwm_p->set_duty(0.0, n + 3);
+      fade.set(n, 0);
+      fade.set(n + 3, 0);
+   }
+}
+
+// reference float hsv to rgb (0.0-1.0), hue in turns
+static void legacy_hsv(double h, double s, double v, double rgb[3]) {
+   double f, p, q, t;
+   int i;
+
+   h = h * 6.0;
+   i = (int) h;
+   f = h - i;
+   p = v * (1.0 - s);
+   q = v * (1.0 - s * f);
+   t = v * (1.0 - s * (1.0 - f));
+   switch (i % 6) {
+   case 0:
+      rgb[0] = v; rgb[1] = t; rgb[2] = p;
+      break;
+   case 1:
+      rgb[0] = q; rgb[1] = v; rgb[2] = p;
+      break;
+   case 2:
+      rgb[0] = p; rgb[1] = v; rgb[2] = t;
+      break;
+   case 3:
+      rgb[0] = p; rgb[1] = q; rgb[2] = v;
+      break;
+   case 4:
+      rgb[0] = t; rgb[1] = p; rgb[2] = v;
+      break;
+   default:
+      rgb[0] = v; rgb[1] = p; rgb[2] = q;
+   }
+}
+
+// |8-bit level - rounded float level|
+static int rgb_diff(uint8_t c, double f) {
+   int d;
+
+   d = (int) c - (int) (f * 255.0 + 0.5);
+   return ((d < 0) ? -d : d);
+}
+
+/**
+ * compare float and integer tri-color led updates
+ *  - legacy: float hsv, 3 x set_duty(double)
+ *  - new: pwm_hsv() and set_color() (white balance + gamma)
+ *  - clocks per 1000 color updates (hue sweep)
+ *  - cross check: max rgb difference (8-bit) over all hues at
+ *    several saturation/value pairs
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void pwm_color_bench(PwmCore *pwm_p) {
+   const int N = 1000;
+   const PwmRgb WB = { 255, 200, 230 };
+   const PwmRgb WB_NONE = { 255, 255, 255 };
+   const PwmRgb OFF = { 0, 0, 0 };
+   double rgb[3];
+   PwmRgb c;
+   uint64_t t0;
+   uint32_t clk_old, clk_new;
+   int i, e, err, s, v;
+
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      legacy_hsv((double) (i % PWM_HUE_MAX) / (double) PWM_HUE_MAX, 1.0, 1.0, rgb);
+      pwm_p->set_duty(rgb[0], 0);
+      pwm_p->set_duty(rgb[1], 1);
+      pwm_p->set_duty(rgb[2], 2);
+   }
+   clk_old = (uint32_t) (now_tick() - t0);
+   pwm_p->set_white_balance(WB, 0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      pwm_p->set_color(pwm_hsv(i, 255, 255), 0);
+   clk_new = (uint32_t) (now_tick() - t0);
+   pwm_p->set_white_balance(WB_NONE, 0);
+   pwm_p->set_color(OFF, 0);
+   err = 0;
+   for (s = 0; s < 256; s = s + 85) {
+      for (v = 15; v < 256; v = v + 80) {
+         for (i = 0; i < PWM_HUE_MAX; i++) {
+            c = pwm_hsv(i, s, v);
+            legacy_hsv((double) i / (double) PWM_HUE_MAX, s / 255.0, v / 255.0, rgb);
+            e = rgb_diff(c.r, rgb[0]);
+            if (rgb_diff(c.g, rgb[1]) > e)
+               e = rgb_diff(c.g, rgb[1]);
+            if (rgb_diff(c.b, rgb[2]) > e)
+               e = rgb_diff(c.b, rgb[2]);
+            if (e > err)
+               err = e;
+         }
+      }
+   }
+   uart.disp("color clocks/1000 updates (float/integer): ");
+   uart.disp((int) clk_old);
+   uart.disp(" / ");
+   uart.disp((int) clk_new);
+   uart.disp(", max hsv error (8-bit): ");
+   uart.disp(err);
+   uart.disp("\n\r");
+}
+
+/**
+ * compare the cost of one pwm channel update
+ *  - legacy: float brightness step, float duty and set_duty(double)
+ *  - PwmFade: integer Q8 step, gamma LUT and set_duty(int) on change
+ *  - clocks per 1000 channel updates; 8 channels breathing
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void pwm_fade_bench(PwmCore *pwm_p) {
+   const int N = 1000;
+   const double P20 = 1.2589;
+   PwmFade fade(pwm_p);
+   double bright[PwmFade::CHANNELS];
+   uint64_t t0;
+   uint32_t clk_old, clk_new;
+   int i, ch, writes;
+
+   for (ch = 0; ch < PwmFade::CHANNELS; ch++)
+      bright[ch] = 1.0 + ch;
+   t0 = now_tick();
+   for (i = 0; i < N / PwmFade::CHANNELS; i++) {
+      for (ch = 0; ch < PwmFade::CHANNELS; ch++) {
+         bright[ch] = bright[ch] * P20;
+         if (bright[ch] > 100.0)
+            bright[ch] = 1.0;
+         pwm_p->set_duty(bright[ch] / 100.0, ch);
+      }
    }
+   clk_old = (uint32_t) (now_tick() - t0);
+   for (ch = 0; ch < PwmFade::CHANNELS; ch++)
+      fade.breathe(ch, 0, PwmFade::LEVEL_MAX, 1000 + 100 * ch);
+   writes = 0;
+   t0 = now_tick();
+   for (i = 0; i < N / PwmFade::CHANNELS; i++)
+      writes = writes + fade.step();
+   clk_new = (uint32_t) (now_tick() - t0);
+   for (ch = 0; ch < PwmFade::CHANNELS; ch++)
+      fade.set(ch, 0);
+   uart.disp("pwm clocks/1000 channel updates (legacy/fade): ");
+   uart.disp((int) clk_old);
+   uart.disp(" / ");
+   uart.disp((int) clk_new);
+   uart.disp(", duty writes: ");
+   uart.disp(N);
+   uart.disp(" / ");
+   uart.disp(writes);
+   uart.disp("\n\r");
 }
 
 /**
@@ -230,6 +385,7 @@ void gsensor_check(SpiCore *spi_p, GpoCore *led_p) {
    const uint8_t PART_ID_REG = 0x02;
    const uint8_t DATA_REG = 0x08;
    const float raw_max = 127.0 / 2.0;  //128 max 8-bit reading for +/-2g
+   const uint32_t TILT_LEDS = 0x03c0;  // leds 6 to 9 show orientation
 
    int8_t xraw, yraw, zraw;
    float x, y, z;
@@ -266,28 +422,16 @@ void gsensor_check(SpiCore *spi_p, GpoCore *led_p) {
    uart.disp("\n\r");
    //0 deg
    if(x<1.1 && x>1){
-  led_p->write(1,6);
-  led_p->write(0,7);
-  led_p->write(0,8);
-  led_p->write(0,9);
+  led_p->write_masked(TILT_LEDS, bit(6));
    }
    if(x<0.1 && x>0){
-  led_p->write(0,6);
-  led_p->write(1,7);
-  led_p->write(0,8);
-  led_p->write(0,9);
+  led_p->write_masked(TILT_LEDS, bit(7));
    }
    if(x<-1 && x>-1.1){
-  led_p->write(0,6);
-  led_p->write(0,7);
-  led_p->write(1,8);
-  led_p->write(0,9);
+  led_p->write_masked(TILT_LEDS, bit(8));
    }
    if(x<0 && x>-0.1){
-  led_p->write(0,6);
-  led_p->write(0,7);
-  led_p->write(0,8);
-  led_p->write(1,9);
+  led_p->write_masked(TILT_LEDS, bit(9));
    }
 
 }
@@ -299,31 +443,10 @@ void gsensor_check(SpiCore *spi_p, GpoCore *led_p) {
 //float tempC;
 
 void sseg_temp(float temp, SsegCore *sseg_p){
-   uint8_t point = 0x10;
-
-   int temp_val = static_cast<int>(temp * 1000.0);
-
-   int num_array[5];
-
-   num_array[0] = (temp_val / 10000) % 10;
-num_array[1] = (temp_val / 1000) % 10;
-num_array[2] = (temp_val / 100) % 10;
-num_array[3] = (temp_val / 10) % 10;
-num_array[4] = (temp_val / 1) % 10;
-
-sseg_p->set_dp(0x00);
-sseg_p->write_1ptn(sseg_p->h2s(12), 0);
-sseg_p->set_dp(point);
-
-for(int i = 0; i < 5; i++){
-sseg_p->write_1ptn(sseg_p->h2s(num_array[i]), 5 - i);
-/*if(i == 4){
-sseg_p->write_1ptn(sseg_p->h2s(12), 0);
-}
-else {
-sseg_p->write_1ptn(sseg_p->h2s(num_array[i]), 5 - i);
-}*/
-}
+   // "dd.dddC": Q16 value, 3 fraction digits on digits 5-1, "C" on digit 0
+   sseg_p->stage_1ptn(sseg_p->h2s(12), 0);
+   sseg_p->show_fixed((int32_t) (temp * 65536.0f), 16, 3, 1, 5,
+         SsegCore::FIELD_ZERO);
 }
 
 
@@ -375,27 +498,47 @@ void adt7420_check(I2cCore *adt7420_p, GpoCore *led_p, SsegCore *sseg_p) {
 
 void displayScores(SsegCore *sseg_p, int num_array[8]){
 
-   sseg_p->set_dp(0x00);
+   sseg_p->stage_dp(0x00);
 
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[0]), 0);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[1]), 1);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[2]), 2);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[3]), 3);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[4]), 4);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[5]), 5);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[6]), 6);
-   sseg_p->write_1ptn(sseg_p->h2s(num_array[7]), 7);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[0]), 0);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[1]), 1);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[2]), 2);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[3]), 3);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[4]), 4);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[5]), 5);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[6]), 6);
+   sseg_p->stage_1ptn(sseg_p->h2s(num_array[7]), 7);
+   sseg_p->commit();    // at most one write per half
 
 }
 
+// player 1 (keyboard) on the left 4 digits, player 2 on the right 4
+void showScores(SsegCore *sseg_p, int player1point, int player2point){
+   sseg_p->show_uint(player2point, 0, 4, SsegCore::FIELD_ZERO);
+   sseg_p->show_uint(player1point, 4, 4, SsegCore::FIELD_ZERO);
+}
+
 
-void catchTheLight(Ps2Core *ps2_p, GpoCore *led_p, SsegCore *sseg_p, GpiCore *sw_p) {
+void catchTheLight(Ps2Core *ps2_p, GpoCore *led_p, SsegCore *sseg_p, GpiCore *sw_p,
+      PwmCore *pwm_p) {
+   const PwmRgb HIT = { 0, 255, 0 };
+   const PwmRgb MISS = { 255, 0, 0 };
+   const PwmRgb OFF = { 0, 0, 0 };
+   PwmRgb color;
+   int hue, hue_prev;
    int id;
-   char ch;
+   Ps2KeyEvent ev;
+   int moles;
+   GpiEdge edge;
+   uint32_t t0, left;
+   LedSeq seq(led_p);
+   LedBcm bcm(led_p);
+   int level, lv;
+   uint32_t lv_step;    // 14 levels per flipTimeSet, Q24
+   uint32_t hue_step;   // PWM_HUE_MAX per flipTimeSet, Q20
+   int elapsed;
    int player1point=0; //keyboard
    int player2point=0; //nexys4ddr
-   int player1point_prev=0;
-   int player2point_prev=0;
    //unsigned long last;
 
    int flipTimeSet = 850;
@@ -403,481 +546,114 @@ void catchTheLight(Ps2Core *ps2_p, GpoCore *led_p, SsegCore *sseg_p, GpiCore *sw
    int win = 0;
    int checked = 0;
 
+   // one divide here; the window loop only multiplies (no divider on the MCS)
+   lv_step = (((uint32_t) 14 << 24) + flipTimeSet - 1) / flipTimeSet;
+   hue_step = (((uint32_t) PWM_HUE_MAX << 20) + flipTimeSet - 1) / flipTimeSet;
    sseg_p->set_dp(0x00);
 
-   int num_array[8];
-
-    num_array[0] = 0;
-    num_array[1] = 0;
-    num_array[2] = 0;
-    num_array[3] = 0;
-    num_array[4] = 0;
-    num_array[5] = 0;
-    num_array[6] = 0;
-    num_array[7] = 0;
-
     uart.disp("Ready to begin game!\n\r");
-    led_check(led_p, 16);
+    ps2_p->init_start();    // device reset runs during the led sweep
+    sw_p->set_debounce(5, 1000);   // switch bounce filtered over 5 ms
+    seq.chase(16, 200, 1);  // plays on while the game accepts keys
 
-    displayScores(sseg_p, num_array);
+    showScores(sseg_p, player1point, player2point);
 
    //uart.disp("\n\rPS2 device (1-keyboard / 2-mouse): ");
-   id = ps2_p->init();
+   do {
+      id = ps2_p->init_poll();
+      seq.poll();
+   } while (id == Ps2Core::INIT_BUSY);
+   log_info(LOG_MOD_PS2, "ps2 id / reset latency (us): ", id,
+         (int) ps2_p->init_latency_us());
+   if (id == 1)
+      ps2_p->set_typematic(0, 0);   // fastest repeat, shortest delay
    //uart.disp(id);
    //uart.disp("\n\r");
 
    do {
-         if (ps2_p->get_kb_ch(&ch)) {
-            player1point_prev = player1point;
-            player2point_prev = player2point;
-
-            if((ch == 'a') && win == 0){ //A keyboard
-               led_p->write(1,0);
-
-               currTime=now_ms();
-               while ( ((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==1) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-
-               }
-
-               led_p->write(0,0);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'b' && win == 0){ //B keyboard
-               led_p->write(1,1);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet) ){
-                  int s=sw_p->read();
-                  if ((s==2) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,1);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'c' && win == 0){ //C keyboard
-               led_p->write(1,2);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==4) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,2);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'd' && win == 0){ //D keyboard
-               led_p->write(1,3);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==8) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,3);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'e' && win == 0){ //E keyboard
-               led_p->write(1,4);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==16) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,4);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'f' && win == 0){ //f keyboard
-               led_p->write(1,5);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==32) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,5);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'g' && win == 0){ //g keyboard
-               led_p->write(1,6);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==64) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,6);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
+         seq.poll();
+         while (ps2_p->get_key_event(&ev))
+            ;     // drain the queue; only the key state is used
+         moles = ps2_p->mole_presses();
+         if (moles) {
+            seq.stop();                // leds belong to the moles now
+
+            // light every mole pressed (a to p); each of their switches must flip
+            // re-seed the filter: a flip still settling would score after t0
+            sw_p->set_debounce(5, 1000);
+            // drop older edges; their stamps would wrap (32-bit us) in a long game
+            while (sw_p->get_edge(&edge))
+               ;
+            // moles dim as their time runs out (16 levels)
+            bcm.start(4, 100, moles);
+            bcm.set_level_mask(moles, 15);
+            level = 15;
+            hue_prev = -1;
+
+            t0 = now_us();
+            left = moles;
+            currTime=now_ms();
+            while ((elapsed = (int) (now_ms() - currTime)) < flipTimeSet) {
+               bcm.poll();
+               // 1 + 14 * (flipTimeSet - elapsed) / flipTimeSet
+               lv = 1 + (int) (((uint32_t) (flipTimeSet - elapsed) * lv_step) >> 24);
+               if (lv != level) {
+                  level = lv;
+                  bcm.set_level_mask(moles, level);
                }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
+               // tri-color leds sweep one hue turn while the mole is up
+               // PWM_HUE_MAX * elapsed / flipTimeSet
+               hue = (int) (((uint32_t) elapsed * hue_step) >> 20);
+               if (hue != hue_prev) {
+                  hue_prev = hue;
+                  color = pwm_hsv(hue, 255, 255);
+                  pwm_p->set_color(color, 0);
+                  pwm_p->set_color(color, 1);
                }
-
-            }
-            if(ch == 'h' && win == 0){ //h keyboard
-               led_p->write(1,7);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==128) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
+               sw_p->poll();
+               while (sw_p->first_edge_since(t0, left, &edge))
+                  left = left & ~bit(edge.bit);   // either direction counts
+               if ((left == 0) && (checked == 0)){
+                  player2point=player2point+100;
+                  checked = 1;
+                  log_info(LOG_MOD_APP, "mole hit - moles / reaction (us): ",
+                        moles, (int) (edge.time_us - t0));
                   break;
-                  }
-               }
-
-               led_p->write(0,7);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'i' && win == 0){ //h keyboard
-               led_p->write(1,8);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==256) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,8);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'j' && win == 0){ //i keyboard
-               led_p->write(1,9);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==512) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,9);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'k' && win == 0){ //j keyboard
-               led_p->write(1,10);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==1024) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,10);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'l' && win == 0){ //k keyboard
-               led_p->write(1,11);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==2048) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,11);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'm' && win == 0){ //l keyboard
-               led_p->write(1,12);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==4096) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,12);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'n' && win == 0){ //m keyboard
-               led_p->write(1,13);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==8192) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
-
-               led_p->write(0,13);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
-            }
-            if(ch == 'o' && win == 0){ //n keyboard
-               led_p->write(1,14);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==16384) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
                }
-
-               led_p->write(0,14);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
-
             }
-            if(ch == 'p' && win == 0){ //n keyboard
-               led_p->write(1,15);
-
-               currTime=now_ms();
-               while (((now_ms() - currTime) < flipTimeSet)){
-                  int s=sw_p->read();
-                  if ((s==32768) && (checked == 0)){
-                     player2point=player2point+100;
-                     checked = 1;
-                     break;
-                  }
-               }
 
-               led_p->write(0,15);
-
-               if (checked == 0 ){
-                  player1point=player1point+100;
-               }
-
-               checked = 0;
-
-               if((player1point > 900) || (player2point > 900)){
-                  win = 1;
-               }
+            bcm.stop();
+            color = (checked) ? HIT : MISS;
+            pwm_p->set_color(color, 0);
+            pwm_p->set_color(color, 1);
 
+            if (checked == 0 ){
+               player1point=player1point+100;
             }
 
-            if(player1point_prev != player1point){
-               num_array[6] = (player1point / 100) % 10;
-               num_array[7] = player1point / 1000;
-            }
+            checked = 0;
 
-            if(player2point_prev != player2point){
-               num_array[2] = (player2point / 100) % 10;
-               num_array[3] = player2point / 1000;
+            if((player1point > 900) || (player2point > 900)){
+               win = 1;
             }
 
-            displayScores(sseg_p, num_array);
+            showScores(sseg_p, player1point, player2point);   // changed half only
 
             uart.disp(" ");
             //last = now_ms();
-         } // end get_kb_ch()
+         } // end mole_presses()
         // end id==2
    } while (win == 0);
 
-   if (player1point > player2point){
-      num_array[7] = 1;
-   }
-   else {
-      num_array[3] = 1;
-   }
-   displayScores(sseg_p, num_array);
-   sleep_ms(2000);
-
+   // the winner's score (1000) already leads with "1"
+   showScores(sseg_p, player1point, player2point);
+   pwm_p->set_color(OFF, 0);
+   pwm_p->set_color(OFF, 1);
    uart.disp("Game over\n\r");
-   led_check(led_p, 16);
+   // flash the leds while the final score is shown (was 2 s + led sweep)
+   seq.blink(0xffff, 250, 4);
+   while (seq.poll())
+      ;
    uart.disp(" ");
    //uart.disp("\n\rExit PS2 test \n\r");
 
@@ -968,24 +744,1836 @@ void adsr_check(AdsrCore *adsr_p, GpoCore *led_p, GpiCore *sw_p) {
    }
 }
 
-GpoCore led(get_slot_addr(BRIDGE_BASE, S2_LED));
-GpiCore sw(get_slot_addr(BRIDGE_BASE, S3_SW));
-XadcCore adc(get_slot_addr(BRIDGE_BASE, S5_XDAC));
-PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
-DebounceCore btn(get_slot_addr(BRIDGE_BASE, S7_BTN));
-SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
-SpiCore spi(get_slot_addr(BRIDGE_BASE, S9_SPI));
-I2cCore adt7420(get_slot_addr(BRIDGE_BASE, S10_I2C));
-Ps2Core ps2(get_slot_addr(BRIDGE_BASE, S11_PS2));
-DdfsCore ddfs(get_slot_addr(BRIDGE_BASE, S12_DDFS));
-AdsrCore adsr(get_slot_addr(BRIDGE_BASE, S13_ADSR), &ddfs);
+/**
+ * compare legacy divide-based time conversion with the reciprocal path
+ *  - clocks per 1000 calls of the now_us()/now_ms() conversion
+ *  - check both paths agree and read_tick() never steps backward
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void timer_bench() {
+   const int N = 1000;
+   volatile uint32_t freq = SYS_CLK_FREQ;  // keep the legacy divide a divide
+   volatile uint64_t sink;                 // keep results alive
+   uint64_t tick, prev, t0;
+   uint32_t div_us, rcp_us, div_ms, rcp_ms;
+   int i, bad, back;
+
+   tick = now_tick();
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = (tick + i) / freq;
+   div_us = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = TimerCore::tick2us(tick + i);
+   rcp_us = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = (tick + i) / freq / 1000;
+   div_ms = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = TimerCore::tick2ms(tick + i);
+   rcp_ms = (uint32_t) (now_tick() - t0);
+   // cross check over a wide range of counts
+   bad = 0;
+   for (i = 0; i < N; i++) {
+      tick = ((uint64_t) i << 38) + (uint64_t) i * 99991;
+      if (TimerCore::tick2us(tick) != tick / freq)
+         bad++;
+      if (TimerCore::tick2ms(tick) != tick / freq / 1000)
+         bad++;
+   }
+   // consecutive reads must be monotonic (also across a lower-word wrap)
+   back = 0;
+   prev = now_tick();
+   for (i = 0; i < N; i++) {
+      tick = now_tick();
+      if (tick < prev)
+         back++;
+      prev = tick;
+   }
+   uart.disp("timer us conversion clocks/1000 calls (divide/reciprocal): ");
+   uart.disp((int) div_us);
+   uart.disp(" / ");
+   uart.disp((int) rcp_us);
+   uart.disp("\n\rtimer ms conversion clocks/1000 calls (divide/reciprocal): ");
+   uart.disp((int) div_ms);
+   uart.disp(" / ");
+   uart.disp((int) rcp_ms);
+   uart.disp("\n\rtimer mismatches/backward steps: ");
+   uart.disp(bad);
+   uart.disp(" / ");
+   uart.disp(back);
+   uart.disp("\n\r");
+   (void) sink;
+}
+
+static int wheel_fired = 0;
+
+// callback of timer_wheel_bench()
+static void wheel_bench_cb(void *) {
+   wheel_fired++;
+}
+
+/**
+ * measure timer wheel poll cost with hundreds of pending timers
+ *  - 500 one-shot/periodic timers with pseudo-random delays up to 2 s
+ *  - step a synthetic clock one wheel tick per poll (no waiting)
+ *  - report average/max clocks per tick
+ */
+void timer_wheel_bench() {
+   const int N = 500;
+   const int TICKS = 2500;
+   static SwTimer tmr[N];
+   static TimerWheel wheel;
+   uint32_t seed, delay, period, clks, max_clks;
+   uint64_t now, t0, total;
+   int i;
+
+   seed = 1;
+   for (i = 0; i < N; i++) {
+      seed = seed * 1103515245 + 12345;
+      delay = (seed >> 8) % 2000000;
+      period = (i % 4 == 0) ? 100000 + delay / 4 : 0;  // 1/4 periodic
+      wheel.start(&tmr[i], delay, period, wheel_bench_cb, 0);
+   }
+   uart.disp("timer wheel pending: ");
+   uart.disp(wheel.pending());
+   now = TimerCore::tick2us(now_tick());
+   total = 0;
+   max_clks = 0;
+   for (i = 0; i < TICKS; i++) {
+      now = now + (1 << TimerWheel::TICK_SHIFT);
+      t0 = now_tick();
+      wheel.poll(now);
+      clks = (uint32_t) (now_tick() - t0);
+      total = total + clks;
+      if (clks > max_clks)
+         max_clks = clks;
+   }
+   uart.disp(", fired: ");
+   uart.disp(wheel_fired);
+   uart.disp(", clocks/tick avg/max: ");
+   uart.disp((int) (total / TICKS));
+   uart.disp(" / ");
+   uart.disp((int) max_clks);
+   uart.disp("\n\r");
+   for (i = 0; i < N; i++)
+      wheel.cancel(&tmr[i]);
+}
+
+/* legacy UartCore::disp(int, int, int) conversion (% and / per digit) */
+static char *legacy_fmt_int(char *buf, int n, int base, int len) {
+   char *str, ch, sign;
+   int rem, i;
+   unsigned int un;
+
+   if (base != 2 && base != 8 && base != 16)
+      base = 10;
+   if (len > 32)
+      len = 32;
+   if (base == 10 && n < 0) {
+      un = (unsigned) -n;
+      sign = '-';
+   } else {
+      un = (unsigned) n;
+      sign = ' ';
+   }
+   str = &buf[FMT_INT_SIZE - 1];
+   *str = '\0';
+   i = 0;
+   do {
+      str--;
+      rem = un % base;
+      un = un / base;
+      if (rem < 10)
+         ch = (char) rem + '0';
+      else
+         ch = (char) rem - 10 + 'a';
+      *str = ch;
+      i++;
+   } while (un);
+   if (sign == '-') {
+      str--;
+      *str = sign;
+      i++;
+   }
+   while (i < len) {
+      str--;
+      *str = ' ';
+      i++;
+   };
+   return (str);
+}
+
+/* legacy UartCore::disp(double, int) conversion (float loop per digit) */
+static char *legacy_fmt_double(char *buf, double f, int digit) {
+   char *p, *s;
+   double fa, frac;
+   int n, i, i_part;
+   char ibuf[FMT_INT_SIZE];
+
+   p = buf;
+   fa = f;
+   if (f < 0.0) {
+      fa = -f;
+      *p++ = '-';
+   }
+   i_part = (int) fa;
+   for (s = legacy_fmt_int(ibuf, i_part, 10, 0); *s; s++)
+      *p++ = *s;
+   *p++ = '.';
+   frac = fa - (double) i_part;
+   for (n = 0; n < digit; n++) {
+      frac = frac * 10.0;
+      i = (int) frac;
+      *p++ = (char) i + '0';
+      frac = frac - i;
+   }
+   *p = '\0';
+   return (buf);
+}
+
+// exact k/1000 with 3 fraction digits, from integers only
+static char *dec_ref(char *buf, int k) {
+   char *p, *s;
+   char ibuf[FMT_INT_SIZE];
+
+   p = buf;
+   if (k < 0) {
+      *p++ = '-';
+      k = -k;
+   }
+   for (s = legacy_fmt_int(ibuf, k / 1000, 10, 0); *s; s++)
+      *p++ = *s;
+   *p++ = '.';
+   *p++ = (char) (k / 100 % 10) + '0';
+   *p++ = (char) (k / 10 % 10) + '0';
+   *p++ = (char) (k % 10) + '0';
+   *p = '\0';
+   return (buf);
+}
+
+static int str_differ(const char *a, const char *b) {
+   while (*a && *a == *b) {
+      a++;
+      b++;
+   }
+   return (*a != *b);
+}
+
+/**
+ * compare legacy divide/float formatting with num_fmt
+ *  - clocks per 1000 conversions: decimal, hex, double (3 digits)
+ *    and Q4 fixed point (adt7420 format)
+ *  - cross check both give the same strings for binary fractions
+ *    and with 0 fraction digits
+ *  - decimal fractions k/1000 (not exact in binary) against the exact
+ *    digits; the legacy loop truncates e.g. 3.3 to "3.299"
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void fmt_bench() {
+   const int N = 1000;
+   static const int BASE[4] = { 10, 16, 2, 8 };
+   static const double DEC[6] = { 0.1, 0.2, 1.7, 3.3, 25.6, -0.5 };
+   volatile char sink;          // keep results alive
+   char buf[FMT_FIXED_SIZE + FMT_INT_SIZE], ref[FMT_FIXED_SIZE + FMT_INT_SIZE];
+   uint64_t t0;
+   uint32_t seed, clk[8];
+   int i, b, n, bad, bad_dec, bad_legacy;
+
+   seed = 12345;
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      sink = *legacy_fmt_int(buf, (int) seed, 10, 0);
+   }
+   clk[0] = (uint32_t) (now_tick() - t0);
+   seed = 12345;
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      sink = *fmt_int(buf, (int) seed, 10, 0);
+   }
+   clk[1] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      sink = *legacy_fmt_int(buf, (int) seed, 16, 0);
+   }
+   clk[2] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      sink = *fmt_int(buf, (int) seed, 16, 0);
+   }
+   clk[3] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = *legacy_fmt_double(buf, (double) (i - 500) * 0.0625, 3);
+   clk[4] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = *fmt_double(buf, (double) (i - 500) * 0.0625, 3);
+   clk[5] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = *legacy_fmt_double(buf, (double) (i - 500) / 16.0, 3);
+   clk[6] = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = *fmt_fixed(buf, i - 500, 4, 3);
+   clk[7] = (uint32_t) (now_tick() - t0);
+   // cross check; doubles use exact binary fractions
+   bad = 0;
+   for (i = 0; i < 4 * N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      n = (i < 64) ? (i - 32) : (int) seed >> (i & 31);
+      if (i == 64)
+         n = (int) 0x80000000;
+      b = BASE[i & 3];
+      if (str_differ(fmt_int(buf, n, b, i % 36), legacy_fmt_int(ref, n, b, i % 36)))
+         bad++;
+      if (str_differ(fmt_double(buf, (double) (n >> 8) / 256.0, 8),
+            legacy_fmt_double(ref, (double) (n >> 8) / 256.0, 8)))
+         bad++;
+      if (str_differ(fmt_fixed(buf, n >> 8, 8, 8),
+            legacy_fmt_double(ref, (double) (n >> 8) / 256.0, 8)))
+         bad++;
+   }
+   for (i = 0; i < 6; i++) {
+      if (str_differ(fmt_double(buf, DEC[i] * 37.0, 0),
+            legacy_fmt_double(ref, DEC[i] * 37.0, 0)))
+         bad++;
+   }
+   // decimal fractions
+   bad_dec = 0;
+   bad_legacy = 0;
+   for (i = -20000; i <= 20000; i++) {
+      dec_ref(ref, i);
+      if (str_differ(fmt_double(buf, (double) i / 1000.0, 3), ref))
+         bad_dec++;
+      if (str_differ(legacy_fmt_double(buf, (double) i / 1000.0, 3), ref))
+         bad_legacy++;
+   }
+   uart.disp("fmt clocks/1000 calls (legacy/new) dec: ");
+   uart.disp((int) clk[0]);
+   uart.disp(" / ");
+   uart.disp((int) clk[1]);
+   uart.disp(", hex: ");
+   uart.disp((int) clk[2]);
+   uart.disp(" / ");
+   uart.disp((int) clk[3]);
+   uart.disp(", double: ");
+   uart.disp((int) clk[4]);
+   uart.disp(" / ");
+   uart.disp((int) clk[5]);
+   uart.disp(", q4 (legacy double): ");
+   uart.disp((int) clk[6]);
+   uart.disp(" / ");
+   uart.disp((int) clk[7]);
+   uart.disp("\n\rfmt mismatches: ");
+   uart.disp(bad);
+   uart.disp(", k/1000 wrong digits (new/legacy): ");
+   uart.disp(bad_dec);
+   uart.disp(" / ");
+   uart.disp(bad_legacy);
+   uart.disp("\n\rfmt new/legacy:");
+   for (i = 0; i < 6; i++) {
+      uart.disp(" ");
+      uart.disp(fmt_double(buf, DEC[i], 3));
+      uart.disp("/");
+      uart.disp(legacy_fmt_double(ref, DEC[i], 3));
+   }
+   uart.disp("\n\r");
+   (void) sink;
+}
 
+/*
+ * recorded switch traces, 1 ms per sample
+ *  - clean press, bouncy press, bouncy release, single-sample spikes
+ */
+static const char *const DB_TRACE[4] = {
+   "000001111111111111111111111111",
+   "000001011010111111111111111111",
+   "111110100101000000000000000000",
+   "000000010000000001000000000000"
+};
+static const int DB_TRACE_CHANGES[4] = { 1, 1, 1, 0 };
+static const int DB_TRACE_LEN = 30;
+
+// 16 inputs at sample t: input k plays trace k % 4 delayed by k / 4
+static uint32_t db_trace_sample(int t) {
+   uint32_t raw;
+   int k, s;
+
+   raw = 0;
+   for (k = 0; k < 16; k++) {
+      s = t - k / 4;
+      if (s < 0)
+         s = 0;
+      if (s >= DB_TRACE_LEN)
+         s = DB_TRACE_LEN - 1;
+      if (DB_TRACE[k % 4][s] == '1')
+         raw = raw | bit(k);
+   }
+   return (raw);
+}
+
+// per-bit counter debouncer (reference for the cost comparison)
+static uint32_t db_per_bit(uint32_t raw, uint32_t state, uint8_t *cnt,
+      int n) {
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      if (bit_read(raw ^ state, i) == 0) {
+         cnt[i] = 0;
+      } else if (++cnt[i] >= n) {
+         cnt[i] = 0;
+         bit_toggle(state, i);
+      }
+   }
+   return (state);
+}
+
+/**
+ * feed the recorded traces to the vertical-counter debouncer
+ *  - window 4 samples; print raw/debounced transitions, errors
+ *    (wrong # changes or final state) and worst settle delay
+ *  - clocks per 1000 noisy samples: per-bit counters vs. bit-sliced,
+ *    and whether both give the same state
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void db_trace_check() {
+   const int N = 4;
+   VertDebounce db;
+   uint8_t cnt[16];
+   uint32_t raw, prev, state, ref, seed;
+   uint64_t t0;
+   uint32_t clk_bit, clk_vert;
+   int t, k, raw_chg, db_chg, bad, settle, delay;
+   int chg[16], last_raw[16];
+
+   prev = db_trace_sample(0);
+   db.init(prev, N);
+   raw_chg = 0;
+   db_chg = 0;
+   settle = 0;
+   for (k = 0; k < 16; k++) {
+      chg[k] = 0;
+      last_raw[k] = 0;
+   }
+   for (t = 1; t < DB_TRACE_LEN + 4; t++) {
+      raw = db_trace_sample(t);
+      db.update(raw);
+      for (k = 0; k < 16; k++) {
+         if (bit_read(raw ^ prev, k)) {
+            raw_chg++;
+            last_raw[k] = t;
+         }
+         if (bit_read(db.changed(), k)) {
+            db_chg++;
+            chg[k]++;
+            delay = t - last_raw[k] + 1;
+            if (delay > settle)
+               settle = delay;
+         }
+      }
+      prev = raw;
+   }
+   bad = 0;
+   for (k = 0; k < 16; k++) {
+      if (chg[k] != DB_TRACE_CHANGES[k % 4] || bit_read(db.read() ^ prev, k))
+         bad++;
+   }
+   // cost: the same pseudo-random samples through both
+   for (k = 0; k < 16; k++)
+      cnt[k] = 0;
+   ref = 0;
+   seed = 12345;
+   t0 = now_tick();
+   for (t = 0; t < 1000; t++) {
+      seed = seed * 1664525 + 1013904223;
+      ref = db_per_bit(seed >> 16, ref, cnt, N);
+   }
+   clk_bit = (uint32_t) (now_tick() - t0);
+   db.init(0, N);
+   state = 0;
+   seed = 12345;
+   t0 = now_tick();
+   for (t = 0; t < 1000; t++) {
+      seed = seed * 1664525 + 1013904223;
+      state = db.update(seed >> 16);
+   }
+   clk_vert = (uint32_t) (now_tick() - t0);
+   uart.disp("debounce transitions raw/debounced: ");
+   uart.disp(raw_chg);
+   uart.disp(" / ");
+   uart.disp(db_chg);
+   uart.disp(", errors: ");
+   uart.disp(bad);
+   uart.disp(", max settle delay (samples): ");
+   uart.disp(settle);
+   uart.disp("\n\r");
+   uart.disp("debounce clocks per 1000 samples per-bit/bit-sliced: ");
+   uart.disp((int) clk_bit);
+   uart.disp(" / ");
+   uart.disp((int) clk_vert);
+   uart.disp(", same state: ");
+   uart.disp(ref == state);
+   uart.disp("\n\r");
+}
+
+static int log_evals = 0;      // # log arguments evaluated
+static int log_sink_calls = 0;
+
+// log argument with a side effect
+static int log_arg(int n) {
+   log_evals++;
+   return (n);
+}
+
+// counting sink of log_check()
+static void log_count_sink(int, int, const char *, int, int) {
+   log_sink_calls++;
+}
+
+/**
+ * show that disabled log statements cost nothing
+ *  - clocks per 1000 loop passes: empty, disabled log_dbg(),
+ *    enabled log_err() to a counting sink
+ *  - # argument evaluations and sink calls of each loop
+ * @note module levels at default (warn): log_dbg() disabled
+ */
+void log_check() {
+   const int N = 1000;
+   volatile int sink;
+   uint64_t t0;
+   uint32_t clk_none, clk_off, clk_on;
+   int i, evals_off;
+
+   log_set_sink(log_count_sink);
+   t0 = now_tick();
+   for (i = 0; i < N; i++)
+      sink = i;
+   clk_none = (uint32_t) (now_tick() - t0);
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      sink = i;
+      log_dbg(LOG_MOD_APP, "log check - i/i: ", log_arg(i), log_arg(i));
+   }
+   clk_off = (uint32_t) (now_tick() - t0);
+   evals_off = log_evals;
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      sink = i;
+      log_err(LOG_MOD_APP, "log check - i/i: ", log_arg(i), log_arg(i));
+   }
+   clk_on = (uint32_t) (now_tick() - t0);
+   log_set_sink(0);
+   uart.disp("log clocks/1000 passes (none/disabled/enabled): ");
+   uart.disp((int) clk_none);
+   uart.disp(" / ");
+   uart.disp((int) clk_off);
+   uart.disp(" / ");
+   uart.disp((int) clk_on);
+   uart.disp("\n\rlog arg evaluations disabled/enabled: ");
+   uart.disp(evals_off);
+   uart.disp(" / ");
+   uart.disp(log_evals - evals_off);
+   uart.disp(", sink calls: ");
+   uart.disp(log_sink_calls);
+   uart.disp("\n\r");
+   log_err(LOG_MOD_APP, "log check - default sink: ", 1, 2);
+   (void) sink;
+}
+
+/* i/o shared by the sched_check() tasks */
+struct SchedCheckIo {
+   GpoCore *led_p;
+   GpiCore *sw_p;
+   DebounceCore *btn_p;
+   TaskScheduler *sched_p;
+   int btn_task;
+   uint32_t btn_old;
+   uint32_t blink;
+   int overruns;         // total already reported
+};
+
+// 10 ms: mirror switches on leds 0-14; release btn task on a change
+static void sw_poll_task(void *arg) {
+   SchedCheckIo *io = (SchedCheckIo *) arg;
+   uint32_t btn;
+
+   io->led_p->write((io->sw_p->read() & 0x7fff) | io->blink);
+   btn = io->btn_p->read_db();
+   if (btn != io->btn_old) {
+      io->btn_old = btn;
+      io->sched_p->signal(io->btn_task);
+   }
+}
+
+// 500 ms: toggle led 15
+static void blink_task(void *arg) {
+   SchedCheckIo *io = (SchedCheckIo *) arg;
+
+   io->blink = io->blink ^ 0x8000;
+}
+
+// event: report debounced buttons
+static void btn_task(void *arg) {
+   SchedCheckIo *io = (SchedCheckIo *) arg;
+
+   uart.disp("buttons: ");
+   uart.disp((int) io->btn_old, 16);
+   uart.disp("\n\r");
+}
+
+// 1 s: heartbeat line
+static void heartbeat_task(void *) {
+   uart.disp("up time (ms): ");
+   uart.disp((int) now_ms());
+   uart.disp("\n\r");
+}
+
+// 1 s, lowest priority: print budget overruns recorded by the dispatcher
+static void overrun_task(void *arg) {
+   SchedCheckIo *io = (SchedCheckIo *) arg;
+   int id, n;
+
+   n = 0;
+   for (id = 0; id < TaskScheduler::MAX_TASKS; id++)
+      n = n + io->sched_p->overruns(id);
+   if (n == io->overruns)
+      return;
+   io->overruns = n;
+   io->sched_p->report();
+}
+
+/**
+ * interleave switch polling, led blink, button events and a heartbeat
+ * with the cooperative scheduler for 3 s; then print wcet table
+ * @param led_p pointer to led instance
+ * @param sw_p pointer to switch instance
+ * @param btn_p pointer to debounce core instance
+ */
+void sched_check(GpoCore *led_p, GpiCore *sw_p, DebounceCore *btn_p) {
+   static TaskScheduler sched;
+   static SchedCheckIo io;
+   unsigned long start;
+
+   io.led_p = led_p;
+   io.sw_p = sw_p;
+   io.btn_p = btn_p;
+   io.sched_p = &sched;
+   io.btn_old = btn_p->read_db();
+   io.blink = 0;
+   io.overruns = 0;
+   // task output goes through the tx ring; no task waits on the fifo
+   uart.set_tx_mode(UartCore::TX_DROP);
+   sched.add_periodic(sw_poll_task, &io, 0, 10000, 100);
+   sched.add_periodic(blink_task, &io, 1, 500000, 100);
+   io.btn_task = sched.add_event(btn_task, &io, 2, 2000);
+   sched.add_periodic(heartbeat_task, &io, 3, 1000000, 2000);
+   sched.add_periodic(overrun_task, &io, 4, 1000000, 0);
+   start = now_ms();
+   while (now_ms() - start < 3000) {
+      sched.run_once();
+   }
+   uart.set_tx_mode(UartCore::TX_UNBUFFERED);   // drain the ring
+   sched.report();
+   uart.disp("add with a 50 s period (rejected): ");
+   uart.disp(sched.add_periodic(heartbeat_task, &io, 5, 50000000, 0));
+   uart.disp("\n\r");
+}
+
+#ifdef __cpp_impl_coroutine
+static int async_spi_id, async_i2c_id;
+
+// read ADXL362 part id (0xf2) without blocking
+static AsyncTask spi_id_task(SpiCore *spi_p) {
+   spi_p->set_freq(400000);
+   spi_p->set_mode(0, 0);
+   spi_p->assert_ss(0);
+   co_await spi_p->transfer_async(0x0b);   // read command
+   co_await spi_p->transfer_async(0x02);   // part id address
+   async_spi_id = co_await spi_p->transfer_async(0x00);
+   spi_p->deassert_ss(0);
+}
+
+// read ADT7420 id register (0xcb) without blocking
+static AsyncTask i2c_id_task(I2cCore *i2c_p) {
+   const uint8_t DEV_ADDR = 0x4b;
+
+   co_await i2c_p->start_async();
+   co_await i2c_p->write_byte_async(DEV_ADDR << 1);
+   co_await i2c_p->write_byte_async(0x0b);      // id register
+   co_await i2c_p->restart_async();
+   co_await i2c_p->write_byte_async((DEV_ADDR << 1) | 0x01);
+   async_i2c_id = co_await i2c_p->read_byte_async(1);
+   co_await i2c_p->stop_async();
+}
+
+// print a message without blocking on a full tx fifo
+static AsyncTask uart_msg_task(const char *str) {
+   while (*str) {
+      co_await uart.tx_byte_async((uint8_t) *str);
+      str++;
+   }
+}
+
+/**
+ * run spi, i2c and uart transactions concurrently as coroutines
+ * and report the # executor passes needed
+ * @param spi_p pointer to spi instance
+ * @param i2c_p pointer to i2c instance
+ */
+void async_check(SpiCore *spi_p, I2cCore *i2c_p) {
+   static AsyncExecutor exec;
+   int passes;
+
+   async_spi_id = -1;
+   async_i2c_id = -1;
+   exec.spawn(spi_id_task(spi_p));
+   exec.spawn(i2c_id_task(i2c_p));
+   exec.spawn(uart_msg_task("async uart message while spi/i2c run\n\r"));
+   passes = 0;
+   while (exec.run_once())
+      passes++;
+   uart.disp("async ADXL362 id / ADT7420 id: ");
+   uart.disp(async_spi_id, 16);
+   uart.disp(" / ");
+   uart.disp(async_i2c_id, 16);
+   uart.disp(", executor passes: ");
+   uart.disp(passes);
+   uart.disp("\n\r");
+}
+#endif  // __cpp_impl_coroutine
+
+// print n 64-char lines; return time spent in disp() (us)
+static uint32_t uart_burst(int n) {
+   uint64_t start;
+   int i;
+
+   start = now_tick();
+   for (i = 0; i < n; i++) {
+      uart.disp("uart burst line ");
+      uart.disp(i, 10, 2);
+      uart.disp(": abcdefghijklmnopqrstuvwxyz0123456789abcdef\n\r");
+   }
+   return ((uint32_t) TimerCore::tick2us(now_tick() - start));
+}
+
+/**
+ * compare disp() stall time of unbuffered and ring-buffered uart tx
+ * with bursts larger than the hardware tx fifo
+ * @note prints dropped byte count and peak ring occupancy
+ */
+void uart_tx_check() {
+   uint32_t unbuf_us, buf_us, drop_us;
+
+   sleep_ms(300);                       // let tx fifo drain
+   unbuf_us = uart_burst(6);
+   sleep_ms(450);
+   uart.set_tx_mode(UartCore::TX_DROP);
+   buf_us = uart_burst(6);              // fits in fifo + ring
+   drop_us = uart_burst(6);             // overflows the ring
+   while (uart.tx_pending())
+      uart.pump();
+   uart.set_tx_mode(UartCore::TX_UNBUFFERED);
+   uart.disp("uart tx stall (us) unbuffered/buffered/overflow: ");
+   uart.disp((int) unbuf_us);
+   uart.disp(" / ");
+   uart.disp((int) buf_us);
+   uart.disp(" / ");
+   uart.disp((int) drop_us);
+   uart.disp(", dropped: ");
+   uart.disp((int) uart.tx_dropped());
+   uart.disp(", peak: ");
+   uart.disp(uart.tx_peak());
+   uart.disp("\n\r");
+}
+
+#ifdef _HOST_SIM
+/**
+ * print bus cost of a routine run on the simulated bus
+ * @param name routine name
+ * @param start_clk virtual bus clock when the routine started
+ * @note access counters are cleared for the next routine
+ */
+void sim_report(const char *name, uint64_t start_clk) {
+   uint32_t rd, wr, us;
+
+   rd = sim_reads(-1);
+   wr = sim_writes(-1);
+   us = (uint32_t) ((sim_clock() - start_clk) / SYS_CLK_FREQ);
+   uart.disp(name);
+   uart.disp(": mmio rd/wr ");
+   uart.disp((int) rd);
+   uart.disp(" / ");
+   uart.disp((int) wr);
+   uart.disp(", bus time (us) ");
+   uart.disp((int) us);
+   uart.disp("\n\r");
+   sim_clear_stats();
+}
+
+/**
+ * count led core writes: per-bit writes vs. masked/deferred updates
+ *  - gsensor_check orientation display (4 positions)
+ *  - 100 frames of a 16-led bar graph set bit by bit
+ */
+void gpo_bench(GpoCore *led_p) {
+   uint32_t w0, tilt_bit, tilt_mask, bar_bit, bar_frame;
+   int i, f, n;
+
+   // orientation: old code wrote leds 6-9 one at a time
+   w0 = sim_writes(S2_LED);
+   for (n = 6; n < 10; n++)
+      for (i = 6; i < 10; i++)
+         led_p->write(i == n, i);
+   tilt_bit = sim_writes(S2_LED) - w0;
+   w0 = sim_writes(S2_LED);
+   for (n = 6; n < 10; n++)
+      led_p->write_masked(0x03c0, bit(n));
+   tilt_mask = sim_writes(S2_LED) - w0;
+   // bar graph: level f % 17 leds lit, each led written per frame
+   w0 = sim_writes(S2_LED);
+   for (f = 0; f < 100; f++)
+      for (i = 0; i < 16; i++)
+         led_p->write(i < f % 17, i);
+   bar_bit = sim_writes(S2_LED) - w0;
+   w0 = sim_writes(S2_LED);
+   led_p->set_deferred(1);
+   for (f = 0; f < 100; f++) {
+      for (i = 0; i < 16; i++)
+         led_p->write(i < f % 17, i);
+      led_p->flush();                   // one write per frame at most
+   }
+   led_p->set_deferred(0);
+   bar_frame = sim_writes(S2_LED) - w0;
+   led_p->write(0);
+   uart.disp("gpo writes orientation per-bit/masked: ");
+   uart.disp((int) tilt_bit);
+   uart.disp(" / ");
+   uart.disp((int) tilt_mask);
+   uart.disp(", bar graph per-bit/deferred: ");
+   uart.disp((int) bar_bit);
+   uart.disp(" / ");
+   uart.disp((int) bar_frame);
+   uart.disp("\n\r");
+}
+
+/**
+ * scripted switch/button changes through the edge queues
+ *  - other switches left up; sw 0 and 2 up at 2 ms, sw 0 down at
+ *    5 ms; button 1 pressed at 3 ms
+ *  - 1 ms polls; print first-edge-since results and all sw events
+ *  - debounced (5 x 1 ms): sw 1 flipped 1 ms before a re-seed must
+ *    give no edge; sw 3 flipped after it must
+ */
+void edge_check(GpiCore *sw_p, DebounceCore *btn_p) {
+   GpiEdge ev;
+   uint32_t t0;
+   int ms, found;
+
+   sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0x8100);   // stale switches
+   sim_slot(S7_BTN)->poke(DebounceCore::DB_DATA_REG, 0);
+   sw_p->poll();
+   btn_p->poll();
+   while (sw_p->get_edge(&ev))
+      ;
+   t0 = (uint32_t) now_us();
+   for (ms = 1; ms <= 8; ms++) {
+      if (ms == 3)
+         sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0x8105);
+      if (ms == 4)
+         sim_slot(S7_BTN)->poke(DebounceCore::DB_DATA_REG, 0x02);
+      if (ms == 6)
+         sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0x8104);
+      sw_p->poll();
+      btn_p->poll();
+      sleep_ms(1);
+   }
+   found = sw_p->first_edge_since(t0, bit(2), &ev);
+   uart.disp("edge sw2 found/rising/delay (us): ");
+   uart.disp(found);
+   uart.disp(" / ");
+   uart.disp(ev.rising);
+   uart.disp(" / ");
+   uart.disp((int) (ev.time_us - t0));
+   uart.disp("\n\r");
+   found = sw_p->first_edge_since(t0 + 4000, bit(0), &ev);
+   uart.disp("edge sw0 after 4 ms found/rising/delay (us): ");
+   uart.disp(found);
+   uart.disp(" / ");
+   uart.disp(ev.rising);
+   uart.disp(" / ");
+   uart.disp((int) (ev.time_us - t0));
+   uart.disp("\n\r");
+   found = btn_p->first_edge_since(t0, 0x1f, &ev);
+   uart.disp("edge btn found/bit/delay (us): ");
+   uart.disp(found);
+   uart.disp(" / ");
+   uart.disp(ev.bit);
+   uart.disp(" / ");
+   uart.disp((int) (ev.time_us - t0));
+   uart.disp("\n\r");
+   while (sw_p->get_edge(&ev)) {
+      uart.disp("edge sw event bit/rising/delay (us): ");
+      uart.disp(ev.bit);
+      uart.disp(" / ");
+      uart.disp(ev.rising);
+      uart.disp(" / ");
+      uart.disp((int) (ev.time_us - t0));
+      uart.disp("\n\r");
+   }
+   sw_p->set_debounce(5, 1000);
+   sleep_ms(2);
+   sw_p->poll();
+   sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0x8106);   // sw 1 up
+   sleep_ms(1);
+   sw_p->poll();                        // seen, not yet stable
+   sw_p->set_debounce(5, 1000);         // re-seed
+   t0 = (uint32_t) now_us();
+   for (ms = 1; ms <= 16; ms++) {
+      if (ms == 8)
+         sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0x810e);   // sw 3 up
+      sw_p->poll();
+      sleep_ms(1);
+   }
+   uart.disp("edge debounced re-seed sw1/sw3 found: ");
+   uart.disp(sw_p->first_edge_since(t0, bit(1), &ev));
+   uart.disp(" / ");
+   uart.disp(sw_p->first_edge_since(t0, bit(3), &ev));
+   uart.disp("\n\r");
+   sw_p->set_debounce(0, 0);
+   sim_slot(S3_SW)->poke(GpiCore::DATA_REG, 0);
+}
+
+/**
+ * play led patterns while other work runs in 1 ms slices
+ *  - 16-led chase, 200 ms per step (the old blocking led_check time)
+ *  - custom 4-frame table played twice
+ *  - print duration (ms), led writes and # work slices for each
+ */
+void led_seq_check(GpoCore *led_p) {
+   static const LedFrame PULSE[] = { { 0x0180, 100 }, { 0x03c0, 100 },
+         { 0x07e0, 150 }, { 0x0000, 150 } };
+   LedSeq seq(led_p);
+   unsigned long t;
+   uint32_t w0;
+   int work;
+
+   w0 = sim_writes(S2_LED);
+   t = now_ms();
+   work = 0;
+   seq.chase(16, 200, 1);
+   while (seq.poll()) {
+      sleep_ms(1);                      // other work
+      work++;
+   }
+   t = now_ms() - t;
+   uart.disp("led seq chase time (ms)/led writes/work slices: ");
+   uart.disp((int) t);
+   uart.disp(" / ");
+   uart.disp((int) (sim_writes(S2_LED) - w0));
+   uart.disp(" / ");
+   uart.disp(work);
+   uart.disp("\n\r");
+   w0 = sim_writes(S2_LED);
+   t = now_ms();
+   work = 0;
+   seq.play(PULSE, 4, 0x07e0, 2);
+   while (seq.poll()) {
+      sleep_ms(1);
+      work++;
+   }
+   t = now_ms() - t;
+   uart.disp("led seq frames time (ms)/led writes/work slices: ");
+   uart.disp((int) t);
+   uart.disp(" / ");
+   uart.disp((int) (sim_writes(S2_LED) - w0));
+   uart.disp(" / ");
+   uart.disp(work);
+   uart.disp("\n\r");
+}
+
+/**
+ * run 16-level bcm on 16 leds (led i at level i) for 200 ms
+ *  - measure each led's on time from the written words
+ *  - print refresh rate, cpu share, led writes per cycle and
+ *    duty (permille) of leds 1/4/8/15 with the worst error
+ */
+void bcm_check(GpoCore *led_p) {
+   LedBcm bcm(led_p);
+   uint64_t on[16], t, t_prev, t_end, total;
+   uint32_t word, w0, hz, cpu;
+   int i, err, e, writes;
+
+   bcm.start(4, 100, 0xffff);
+   for (i = 0; i < 16; i++) {
+      bcm.set_level(i, i);
+      on[i] = 0;
+   }
+   w0 = sim_writes(S2_LED);
+   word = led_p->read_shadow();
+   t_prev = now_tick();
+   total = 0;
+   t_end = t_prev + 200000ULL * SYS_CLK_FREQ;
+   while (t_prev < t_end) {
+      bcm.poll();
+      t = now_tick();
+      for (i = 0; i < 16; i++)
+         if (bit_read(word, i))
+            on[i] += t - t_prev;
+      total += t - t_prev;
+      word = led_p->read_shadow();
+      t_prev = t;
+   }
+   hz = bcm.refresh_hz();
+   cpu = bcm.cpu_ppm();
+   writes = (int) (sim_writes(S2_LED) - w0);
+   bcm.stop();
+   err = 0;
+   for (i = 0; i < 16; i++) {
+      e = (int) (on[i] * 1000 / total) - i * 1000 / 15;
+      if (e < 0)
+         e = -e;
+      if (e > err)
+         err = e;
+   }
+   uart.disp("bcm refresh (Hz)/cpu (ppm)/writes per cycle x10: ");
+   uart.disp((int) hz);
+   uart.disp(" / ");
+   uart.disp((int) cpu);
+   uart.disp(" / ");
+   uart.disp(writes * 10 / (int) (hz / 5));
+   uart.disp("\n\r");
+   uart.disp("bcm duty (permille) led 1/4/8/15: ");
+   uart.disp((int) (on[1] * 1000 / total));
+   uart.disp(" / ");
+   uart.disp((int) (on[4] * 1000 / total));
+   uart.disp(" / ");
+   uart.disp((int) (on[8] * 1000 / total));
+   uart.disp(" / ");
+   uart.disp((int) (on[15] * 1000 / total));
+   uart.disp(", max error: ");
+   uart.disp(err);
+   uart.disp("\n\r");
+}
+
+/**
+ * check sigma-delta pwm dithering
+ *  - 8 channels at low 16-bit duties; time-weighted average of the
+ *    duty registers over 256 periods vs. the requested duty
+ *  - cpu share at 1 kHz with all channels dithering
+ *  - # distinct outputs of a slow low-level fade (0 to 16 in 1 s),
+ *    without and with dithering
+ */
+void pwm_dither_check(PwmCore *pwm_p) {
+   const int FREQ = 1000;
+   PwmDither dither(pwm_p);
+   PwmFade fade(pwm_p);
+   SimSlot *slot = sim_slot(S6_PWM);
+   uint64_t sum[PwmDither::CHANNELS], t, t_prev, t_end, total;
+   uint32_t hz, cpu;
+   int ch, err, e, steps[2], pass;
+
+   dither.start(FREQ);
+   for (ch = 0; ch < PwmDither::CHANNELS; ch++) {
+      dither.set_duty(5 * 64 + 9 * ch + 1, ch);
+      sum[ch] = 0;
+   }
+   dither.clear_stats();
+   t_prev = now_tick();
+   total = 0;
+   t_end = t_prev + 256000ULL * SYS_CLK_FREQ;
+   while (t_prev < t_end) {
+      dither.poll();
+      t = now_tick();
+      for (ch = 0; ch < PwmDither::CHANNELS; ch++)
+         sum[ch] += slot->peek(PwmCore::DUTY_REG_BASE + ch) * (t - t_prev);
+      total += t - t_prev;
+      t_prev = t;
+   }
+   hz = dither.rate_hz();
+   cpu = dither.cpu_ppm();
+   err = 0;
+   for (ch = 0; ch < PwmDither::CHANNELS; ch++) {
+      // error in 1/2^BITS of full scale
+      e = (int) (sum[ch] * 64 / total) - (5 * 64 + 9 * ch + 1);
+      if (e < 0)
+         e = -e;
+      if (e > err)
+         err = e;
+   }
+   // slow fade at the bottom of the gamma curve
+   for (pass = 0; pass < 2; pass++) {
+      fade.set_dither(pass ? &dither : 0);
+      fade.set(0, 0);
+      fade.fade(0, 16, 1000);
+      steps[pass] = 0;
+      while (fade.busy(0)) {
+         steps[pass] += fade.poll();
+         dither.poll();
+      }
+   }
+   dither.stop();
+   fade.set_dither(0);
+   fade.set(0, 0);
+   for (ch = 1; ch < PwmDither::CHANNELS; ch++)
+      pwm_p->set_duty(0, ch);
+   uart.disp("dither rate (Hz)/cpu (ppm, 8 ch): ");
+   uart.disp((int) hz);
+   uart.disp(" / ");
+   uart.disp((int) cpu);
+   uart.disp(", max avg error (1/65536): ");
+   uart.disp(err);
+   uart.disp("\n\r");
+   uart.disp("dither fade 0-16 distinct duties (10-bit/dithered): ");
+   uart.disp(steps[0]);
+   uart.disp(" / ");
+   uart.disp(steps[1]);
+   uart.disp("\n\r");
+}
+
+// register words of the original SsegCore::write_led() bit loops
+static void legacy_sseg_words(const uint8_t *ptn, uint8_t pt, uint32_t *w) {
+   uint8_t dp = ~pt;
+   int h, i;
+
+   for (h = 0; h < 2; h++) {
+      w[h] = 0;
+      for (i = 0; i < 4; i++)
+         w[h] = (w[h] << 8) | ptn[4 * h + 3 - i];
+      for (i = 0; i < 4; i++)
+         bit_write(w[h], 7 + 8 * i, bit_read(dp, 4 * h + i));
+   }
+}
+
+// 1 if the sseg registers hold the legacy words
+static int sseg_match(const uint8_t *ptn, uint8_t pt) {
+   uint32_t w[2];
+
+   legacy_sseg_words(ptn, pt, w);
+   return (sim_slot(S8_SSEG)->peek(SsegCore::DATA_LOW_REG) == w[0] &&
+         sim_slot(S8_SSEG)->peek(SsegCore::DATA_HIGH_REG) == w[1]);
+}
+
+/**
+ * count sseg mmio writes of the score and temperature displays
+ *  - per-call writes (set_dp + 8 x write_1ptn) vs. staged displayScores()
+ *    for a score change in one half, in both halves and no change
+ *  - sseg_temp() with a new and with the same reading
+ *  - register words cross checked against the original packing
+ * @note the original write_led() wrote 2 registers per call: 18 for
+ *       displayScores() and 14 for sseg_temp()
+ */
+void sseg_mmio_check(SsegCore *sseg_p) {
+   static const int SCORES[3][8] = {
+      { 0, 0, 9, 1, 0, 0, 0, 0 },   // player 2 score: low half
+      { 0, 0, 9, 1, 0, 0, 9, 1 },   // both players: both halves
+      { 0, 0, 9, 1, 0, 0, 9, 1 }    // no change
+   };
+   static const int ZERO[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+   static const uint8_t BLANK[8] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+         0xff, 0xff };
+   static const uint8_t TEMP_PTN[8] = { 0xc6, 0xb0, 0x99, 0x80, 0xf9,
+         0xa4, 0xff, 0xff };        // "  21.843C" (dp digit 4)
+   const int *from;
+   uint8_t ptn[8];
+   uint32_t w0;
+   int i, k, per_call[3], staged[3], temp[2], bad;
+
+   bad = 0;
+   for (k = 0; k < 3; k++) {
+      from = (k == 2) ? SCORES[2] : ZERO;
+      // per-call sequence of the original displayScores()
+      displayScores(sseg_p, (int *) from);
+      w0 = sim_writes(S8_SSEG);
+      sseg_p->set_dp(0x00);
+      for (i = 0; i < 8; i++)
+         sseg_p->write_1ptn(sseg_p->h2s(SCORES[k][i]), i);
+      per_call[k] = (int) (sim_writes(S8_SSEG) - w0);
+      // staged
+      displayScores(sseg_p, (int *) from);
+      w0 = sim_writes(S8_SSEG);
+      displayScores(sseg_p, (int *) SCORES[k]);
+      staged[k] = (int) (sim_writes(S8_SSEG) - w0);
+      for (i = 0; i < 8; i++)
+         ptn[i] = sseg_p->h2s(SCORES[k][i]);
+      if (!sseg_match(ptn, 0x00))
+         bad++;
+   }
+   sseg_p->write_8ptn((uint8_t *) BLANK);
+   for (k = 0; k < 2; k++) {
+      w0 = sim_writes(S8_SSEG);
+      sseg_temp(21.84375, sseg_p);
+      temp[k] = (int) (sim_writes(S8_SSEG) - w0);
+   }
+   if (!sseg_match(TEMP_PTN, 0x10))
+      bad++;
+   uart.disp("sseg writes per-call/staged, score low/both/none: ");
+   for (k = 0; k < 3; k++) {
+      uart.disp(per_call[k]);
+      uart.disp(" / ");
+      uart.disp(staged[k]);
+      uart.disp((k < 2) ? ", " : "\n\r");
+   }
+   uart.disp("sseg_temp writes new/same: ");
+   uart.disp(temp[0]);
+   uart.disp(" / ");
+   uart.disp(temp[1]);
+   uart.disp(", mismatches: ");
+   uart.disp(bad);
+   uart.disp("\n\r");
+}
+
+/**
+ * compare per-digit divide rendering with SsegCore::show_xxx()
+ *  - clocks per 1000 8-digit numbers: 8 x (/ and %) + h2s per digit
+ *    vs. show_uint() (double dabble); both stage and commit
+ *  - cross check the register words of both; fixed field cases
+ *    (shared display, left aligned, sign, dp, overflow)
+ * @note clocks are cpu cycles on the board; host clocks with _HOST_SIM
+ */
+void sseg_num_bench(SsegCore *sseg_p) {
+   const int N = 1000;
+   static const uint32_t POW10[8] = { 1, 10, 100, 1000, 10000, 100000,
+         1000000, 10000000 };
+   // expected patterns (digit 0 first) and decimal points of the cases
+   static const uint8_t CASE_PTN[4][8] = {
+      { 0xc0, 0xc0, 0x90, 0xf9, 0xc0, 0xc0, 0xb0, 0xff },  // 1900 | " 300"
+      { 0xff, 0xff, 0xff, 0xff, 0xff, 0xa4, 0x99, 0xbf },  // "-42     "
+      { 0xc0, 0x92, 0xc0, 0xbf, 0xff, 0xff, 0xff, 0xff },  // "    -0.50"
+      { 0xbf, 0xbf, 0xbf, 0xbf, 0xbf, 0xbf, 0xbf, 0xbf }   // overflow
+   };
+   static const uint8_t CASE_DP[4] = { 0x00, 0x00, 0x04, 0x00 };
+   static const uint8_t BLANK[8] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+         0xff, 0xff };
+   uint8_t ptn[8];
+   uint64_t t0;
+   uint32_t seed, n, clk_old, clk_new;
+   int i, d, bad, ret[4];
+
+   seed = 2024;
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      n = seed >> 5;                     // < 2^27
+      if (n > SsegCore::MAX_UINT)
+         n = n - SsegCore::MAX_UINT;
+      for (d = 0; d < 8; d++)
+         sseg_p->stage_1ptn(sseg_p->h2s((n / POW10[d]) % 10), d);
+      sseg_p->stage_dp(0x00);
+      sseg_p->commit();
+   }
+   clk_old = (uint32_t) (now_tick() - t0);
+   seed = 2024;
+   t0 = now_tick();
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      n = seed >> 5;
+      if (n > SsegCore::MAX_UINT)
+         n = n - SsegCore::MAX_UINT;
+      sseg_p->show_uint(n, 0, 8, SsegCore::FIELD_ZERO);
+   }
+   clk_new = (uint32_t) (now_tick() - t0);
+   // cross check
+   bad = 0;
+   for (i = 0; i < N; i++) {
+      seed = seed * 1664525 + 1013904223;
+      n = (i < 16) ? POW10[i & 7] - (i >> 3) : (seed >> (5 + (i & 7)));
+      if (n > SsegCore::MAX_UINT)
+         n = n - SsegCore::MAX_UINT;
+      sseg_p->show_uint(n, 0, 8, SsegCore::FIELD_ZERO);
+      for (d = 0; d < 8; d++)
+         ptn[d] = sseg_p->h2s((n / POW10[d]) % 10);
+      if (!sseg_match(ptn, 0x00))
+         bad++;
+   }
+   ret[0] = sseg_p->show_uint(1900, 0, 4, SsegCore::FIELD_ZERO);
+   ret[0] = ret[0] && sseg_p->show_uint(300, 4, 4, SsegCore::FIELD_RIGHT);
+   bad = bad + !sseg_match(CASE_PTN[0], CASE_DP[0]);
+   ret[1] = sseg_p->show_int(-42, 0, 8, SsegCore::FIELD_LEFT);
+   bad = bad + !sseg_match(CASE_PTN[1], CASE_DP[1]);
+   sseg_p->write_8ptn((uint8_t *) BLANK);
+   ret[2] = sseg_p->show_fixed(-128, 8, 2, 0, 4, SsegCore::FIELD_RIGHT);
+   bad = bad + !sseg_match(CASE_PTN[2], CASE_DP[2]);
+   ret[3] = sseg_p->show_uint(123456789);
+   bad = bad + !sseg_match(CASE_PTN[3], CASE_DP[3]);
+   bad = bad + (ret[0] != 1) + (ret[1] != 1) + (ret[2] != 1) + (ret[3] != 0);
+   uart.disp("sseg clocks/1000 numbers (divide/double dabble): ");
+   uart.disp((int) clk_old);
+   uart.disp(" / ");
+   uart.disp((int) clk_new);
+   uart.disp(", mismatches: ");
+   uart.disp(bad);
+   uart.disp("\n\r");
+}
+
+// print uart/timer mmio accesses per byte since the last clear
+static void uart_access_report(const char *name, int n) {
+   uint32_t rd, wr, trd;
+
+   rd = sim_reads(UART_SLOT);
+   wr = sim_writes(UART_SLOT);
+   trd = sim_reads(TIMER_SLOT);
+   uart.tx_flush();
+   uart.disp(name);
+   uart.disp(" (x100 per byte) uart rd/wr, timer rd: ");
+   uart.disp((int) (rd * 100 / n));
+   uart.disp(" / ");
+   uart.disp((int) (wr * 100 / n));
+   uart.disp(", ");
+   uart.disp((int) (trd * 100 / n));
+   uart.disp("\n\r");
+}
+
+/**
+ * compare mmio accesses per byte of per-byte and bulk uart tx/rx
+ * @note 200-byte tx block (fits in the fifo) and 64 injected rx bytes
+ */
+void uart_bulk_check() {
+   static uint8_t buf[200];
+   uint32_t lost[3];
+   int i, n;
+
+   for (i = 0; i < 200; i++)
+      buf[i] = (i % 64 == 63) ? '\n' : (uint8_t) ('a' + i % 26);
+   // tx: one byte at a time
+   sleep_ms(300);                       // let tx fifo drain
+   sim_clear_stats();
+   for (i = 0; i < 200; i++)
+      uart.tx_byte(buf[i]);
+   uart_access_report("tx_byte", 200);
+   // tx: bulk
+   sleep_ms(300);
+   sim_clear_stats();
+   lost[0] = sim_uart()->tx_lost();
+   uart.write(buf, 200);
+   lost[0] = sim_uart()->tx_lost() - lost[0];
+   uart_access_report("write", 200);
+   // tx: bulk right after byte writes (fifo already filled by tx_byte)
+   sleep_ms(300);
+   lost[1] = sim_uart()->tx_lost();
+   for (i = 0; i < 200; i++)
+      uart.tx_byte(buf[i]);
+   uart.write(buf, 200);
+   lost[1] = sim_uart()->tx_lost() - lost[1];
+   // tx: two bulk writes back to back (second one waits on the bound)
+   sleep_ms(300);
+   lost[2] = sim_uart()->tx_lost();
+   uart.write(buf, 200);
+   uart.write(buf, 200);
+   lost[2] = sim_uart()->tx_lost() - lost[2];
+   uart.tx_flush();
+   uart.disp("\n\rtx bytes lost - write/after tx_byte/back to back: ");
+   uart.disp((int) lost[0]);
+   uart.disp(" / ");
+   uart.disp((int) lost[1]);
+   uart.disp(" / ");
+   uart.disp((int) lost[2]);
+   uart.disp("\n\r");
+   sleep_ms(300);
+   // rx: one byte at a time
+   for (i = 0; i < 64; i++)
+      sim_uart()->rx_push((uint8_t) i);
+   sim_clear_stats();
+   n = 0;
+   while (uart.rx_byte() != -1)
+      n++;
+   uart_access_report("rx_byte", n);
+   // rx: bulk
+   for (i = 0; i < 64; i++)
+      sim_uart()->rx_push((uint8_t) i);
+   sim_clear_stats();
+   n = uart.read(buf, 200);
+   uart_access_report("read", n);
+   uart.disp("\n\r");
+}
+
+/**
+ * compare uart bytes of text output and BLOG records
+ *  - one adc_check() report (5 lines, float arguments)
+ *  - one debug() line (integer arguments)
+ * @note decode the captured output with tools/log_decode; the
+ *       escape check line must read "-128 7fffffff -1.0"
+ */
+void blog_check(XadcCore *adc_p) {
+   uint32_t text_adc, bin_adc, text_dbg, bin_dbg;
+   double reading;
+   int n;
+
+   // plausible readings: vcc 1.0 V, 40 C, channels 0.2 V apart
+   sim_slot(S5_XDAC)->poke(XadcCore::VCC_REG, 1365 << 4);
+   sim_slot(S5_XDAC)->poke(XadcCore::TMP_REG, 2545 << 4);
+   for (n = 0; n < 4; n++)
+      sim_slot(S5_XDAC)->poke(n, (819 * (n + 1)) << 4);
+   sim_clear_stats();
+   uart.disp("FPGA vcc/temp: ");
+   reading = adc_p->read_fpga_vcc();
+   uart.disp(reading, 3);
+   uart.disp(" / ");
+   reading = adc_p->read_fpga_temp();
+   uart.disp(reading, 3);
+   uart.disp("\n\r");
+   for (n = 0; n < 4; n++) {
+      uart.disp("analog channel/voltage: ");
+      uart.disp(n);
+      uart.disp(" / ");
+      reading = adc_p->read_adc_in(n);
+      uart.disp(reading, 3);
+      uart.disp("\n\r");
+   }
+   text_adc = sim_writes(UART_SLOT);
+   sim_clear_stats();
+   BLOG("FPGA vcc/temp: %.3f / %.3f\n\r", adc_p->read_fpga_vcc(),
+         adc_p->read_fpga_temp());
+   for (n = 0; n < 4; n++)
+      BLOG("analog channel/voltage: %d / %.3f\n\r", n, adc_p->read_adc_in(n));
+   bin_log.flush();
+   bin_adc = sim_writes(UART_SLOT);
+   sim_clear_stats();
+   debug_on("timer check - (loop #)/now: ", 3, (int) now_ms());
+   text_dbg = sim_writes(UART_SLOT);
+   sim_clear_stats();
+   BLOG("debug: timer check - (loop #)/now: %d(0x%x) / %d(0x%x) \n\r", 3, 3,
+         (int) now_ms(), (int) now_ms());
+   bin_log.flush();
+   bin_dbg = sim_writes(UART_SLOT);
+   // payload bytes 0xff/0xfe (id, zigzag -128, float -1.0) are escaped
+   BLOG("blog escape check: %d %x %.1f\n\r", -128, 0x7fffffff, -1.0);
+   bin_log.flush();
+   uart.disp("blog uart bytes text/binary adc report: ");
+   uart.disp((int) text_adc);
+   uart.disp(" / ");
+   uart.disp((int) bin_adc);
+   uart.disp(", debug line: ");
+   uart.disp((int) text_dbg);
+   uart.disp(" / ");
+   uart.disp((int) bin_dbg);
+   uart.disp(", dropped: ");
+   uart.disp((int) bin_log.dropped());
+   uart.disp("\n\r");
+}
+
+/**
+ * feed a scripted keyboard byte stream to the ps2 decoder
+ *  - 'a' press/release with the 0xf0 arriving 5 ms before its code
+ *  - shifted 'a', extended up-arrow press/release
+ *  - Pause (e1 14 77 e1 f0 14 f0 77): one KEY_PAUSE event, no
+ *    ctrl/num lock key left down
+ *  - print each event: code, flags, char, delay from arrival (us)
+ */
+void kb_check(Ps2Core *ps2_p) {
+   static const uint8_t BYTES[] = { 0x1c, 0xf0, 0x1c, 0x12, 0x1c, 0xf0,
+         0x1c, 0xf0, 0x12, 0xe0, 0x75, 0xe0, 0xf0, 0x75, 0xe1, 0x14, 0x77,
+         0xe1, 0xf0, 0x14, 0xf0, 0x77 };
+   static const uint32_t AT_MS[] = { 1, 10, 15, 20, 21, 22, 22, 23, 23, 30,
+         30, 35, 35, 35, 38, 38, 38, 38, 38, 38, 38, 38 };
+   static Ps2KeyEvent ev[16];
+   unsigned long start, stall;
+   char ch;
+   int i, n, lone;
+
+   sleep_ms(300);                       // let uart output drain
+   start = now_us();
+   for (i = 0; i < (int) sizeof(BYTES); i++)
+      sim_ps2()->rx_push(BYTES[i], AT_MS[i] * 1000);
+   // lone break prefix must not block get_kb_ch()
+   sleep_ms(12);
+   ps2_p->get_kb_ch(&ch);               // consumes the 'a' press
+   stall = now_us();
+   lone = ps2_p->get_kb_ch(&ch);        // only 0xf0 pending
+   stall = now_us() - stall;
+   // poll every 1 ms until the script is done
+   n = 0;
+   while (now_us() - start < 45000) {
+      while (n < 16 && ps2_p->get_key_event(&ev[n]))
+         n++;
+      sleep_ms(1);
+   }
+   uart.disp("kb get_kb_ch with lone 0xf0 - result/time (us): ");
+   uart.disp(lone);
+   uart.disp(" / ");
+   uart.disp((int) stall);
+   uart.disp("\n\r");
+   for (i = 0; i < n; i++) {
+      uart.disp("kb event code/flags/char/time (us): ");
+      uart.disp(ev[i].code, 16);
+      uart.disp(" / ");
+      uart.disp(ev[i].flags);
+      uart.disp(" / ");
+      uart.disp((ev[i].ch >= ' ' && ev[i].ch < 0x7f) ? ev[i].ch : '-');
+      uart.disp(" / ");
+      uart.disp((int) (ev[i].time_us - start));
+      uart.disp("\n\r");
+   }
+   uart.disp("kb after pause - ctrl/num lock/ext ctrl down: ");
+   uart.disp(ps2_p->is_down(0x14));
+   uart.disp(" / ");
+   uart.disp(ps2_p->is_down(0x77));
+   uart.disp(" / ");
+   uart.disp(ps2_p->is_down(Ps2Core::KEY_EXT_CODE + 0x14));
+   uart.disp("\n\r");
+}
+
+/**
+ * check the key map with held and chorded keys
+ *  - hold 'a', 'p' and extended right-arrow; tap 'b' within one poll
+ *    2 ms later; polled every 500 us
+ *  - print held/pressed masks, is_down() results, the a-to-b press
+ *    stamp difference (must be > 0), then the state after all keys
+ *    are released
+ */
+void kb_chord_check(Ps2Core *ps2_p) {
+   static const uint8_t HOLD[] = { 0x1c, 0x4d, 0xe0, 0x74, 0x32, 0xf0, 0x32,
+         0x1c };
+   static const uint32_t AT_US[] = { 1000, 1000, 1000, 1000, 3000, 3000,
+         3000, 4000 };
+   static const uint8_t RELEASE[] = { 0xf0, 0x1c, 0xf0, 0x4d, 0xe0, 0xf0,
+         0x74 };
+   Ps2KeyEvent ev;
+   uint16_t held, pressed;
+   int i, a, arrow, arrow_norm, a_to_b;
+
+   for (i = 0; i < (int) sizeof(HOLD); i++)
+      sim_ps2()->rx_push(HOLD[i], AT_US[i]);   // last 0x1c: typematic repeat
+   for (i = 0; i < 10; i++) {
+      sleep_us(500);
+      while (ps2_p->get_key_event(&ev))
+         ;
+   }
+   held = ps2_p->mole_keys();
+   pressed = ps2_p->mole_presses();
+   a = ps2_p->is_down(0x1c);
+   arrow = ps2_p->is_down(Ps2Core::KEY_EXT_CODE + 0x74);
+   arrow_norm = ps2_p->is_down(0x74);      // keypad 6, not pressed
+   a_to_b = (int) (ps2_p->mole_press_us(1) - ps2_p->mole_press_us(0));
+   uart.disp("kb chord held/pressed mask: ");
+   uart.disp((int) held, 16);
+   uart.disp(" / ");
+   uart.disp((int) pressed, 16);
+   uart.disp(", a/arrow/kp6 down: ");
+   uart.disp(a);
+   uart.disp(arrow);
+   uart.disp(arrow_norm);
+   uart.disp(", a-to-b press stamp (us): ");
+   uart.disp(a_to_b);
+   uart.disp((a_to_b > 0) ? "\n\r" : " (error: not after a)\n\r");
+   for (i = 0; i < (int) sizeof(RELEASE); i++)
+      sim_ps2()->rx_push(RELEASE[i], 1000);
+   sleep_ms(2);
+   while (ps2_p->get_key_event(&ev))
+      ;
+   uart.disp("kb chord after release held/pressed/arrow: ");
+   uart.disp((int) ps2_p->mole_keys(), 16);
+   uart.disp(" / ");
+   uart.disp((int) ps2_p->mole_presses(), 16);
+   uart.disp(" / ");
+   uart.disp(ps2_p->is_down(Ps2Core::KEY_EXT_CODE + 0x74));
+   uart.disp("\n\r");
+}
+
+/**
+ * feed a misaligned mouse byte stream to the packet decoder
+ *  - 2 stray bytes, 2 moves, left click, move, release, x overflow
+ *  - print each coalesced report and the # realignment drops
+ */
+void mouse_check(Ps2Core *ps2_p) {
+   static const uint8_t BYTES[] = { 0x05, 0x03, 0x08, 0x05, 0x02, 0x28,
+         0x03, 0xfe, 0x09, 0x00, 0x00, 0x09, 0x01, 0x00, 0x08, 0x00, 0x00,
+         0x48, 0x10, 0x00 };
+   int i, lbtn, rbtn, x, y;
+
+   for (i = 0; i < (int) sizeof(BYTES); i++)
+      sim_ps2()->rx_push(BYTES[i], 1000);
+   sleep_ms(2);
+   for (i = 0; i < 5; i++) {
+      uart.disp("mouse report/l/r/dx/dy: ");
+      uart.disp(ps2_p->get_mouse_activity(&lbtn, &rbtn, &x, &y));
+      uart.disp(" / ");
+      uart.disp(lbtn);
+      uart.disp(" / ");
+      uart.disp(rbtn);
+      uart.disp(" / ");
+      uart.disp(x);
+      uart.disp(" / ");
+      uart.disp(y);
+      uart.disp("\n\r");
+      lbtn = rbtn = x = y = 0;
+   }
+   uart.disp("mouse resync drops: ");
+   uart.disp((int) ps2_p->mouse_resyncs());
+   uart.disp("\n\r");
+}
+
+/**
+ * time ps2 init() against the old fixed 2 s wait
+ *  - keyboard answering after 300 ms, then a silent device
+ *  - init_start() overlapped with 16 polled 10 ms work steps
+ *  - print result, elapsed time and measured reset latency (ms)
+ */
+void ps2_init_check(Ps2Core *ps2_p) {
+   unsigned long t;
+   int id, steps;
+
+   sim_ps2()->set_reset_ms(300);
+   t = now_ms();
+   id = ps2_p->init();
+   t = now_ms() - t;
+   uart.disp("ps2 init keyboard id/time/latency (ms): ");
+   uart.disp(id);
+   uart.disp(" / ");
+   uart.disp((int) t);
+   uart.disp(" / ");
+   uart.disp((int) (ps2_p->init_latency_us() / 1000));
+   uart.disp("\n\r");
+   // device that never finishes its self test
+   sim_ps2()->set_reset_ms(5000);
+   t = now_ms();
+   id = ps2_p->init();
+   t = now_ms() - t;
+   uart.disp("ps2 init silent device id/time (ms): ");
+   uart.disp(id);
+   uart.disp(" / ");
+   uart.disp((int) t);
+   uart.disp("\n\r");
+   sleep_ms(3000);                      // let the late 0xaa arrive
+   while (ps2_p->rx_byte() != -1)
+      ;
+   // background init polled between other work
+   sim_ps2()->set_reset_ms(300);
+   t = now_ms();
+   ps2_p->init_start();
+   steps = 0;
+   do {
+      sleep_ms(10);                     // other start-up work
+      steps++;
+      id = ps2_p->init_poll();
+   } while (id == Ps2Core::INIT_BUSY);
+   t = now_ms() - t;
+   uart.disp("ps2 init background id/time (ms)/work steps: ");
+   uart.disp(id);
+   uart.disp(" / ");
+   uart.disp((int) t);
+   uart.disp(" / ");
+   uart.disp(steps);
+   uart.disp("\n\r");
+   sim_ps2()->set_reset_ms(500);
+}
+
+/**
+ * run keyboard commands while scan codes arrive
+ *  - typematic, LEDs and scan set queued during an 'a' press/release
+ *  - one resend (0xfe), then a command failing all retries followed
+ *    by one that must still go out
+ *  - scan set 0 (query) and 4 must be rejected without queueing
+ *  - print events received, completion time, longest poll (us) and
+ *    # failed commands
+ */
+void ps2_cmd_check(Ps2Core *ps2_p) {
+   static const uint8_t BYTES[] = { 0x1c, 0xf0, 0x1c };
+   Ps2KeyEvent ev;
+   unsigned long start, t, t_done, t_max;
+   int i, n, bad_set;
+
+   bad_set = ps2_p->set_scan_set(0) + ps2_p->set_scan_set(4);
+   uart.disp("ps2 cmd scan set 0+4 result/pending: ");
+   uart.disp(bad_set);
+   uart.disp(" / ");
+   uart.disp(ps2_p->cmd_pending());
+   uart.disp("\n\r");
+   start = now_us();
+   for (i = 0; i < (int) sizeof(BYTES); i++)
+      sim_ps2()->rx_push(BYTES[i], 1000 + i * 1500);
+   ps2_p->set_typematic(0, 0);
+   ps2_p->set_kb_leds(Ps2Core::LED_CAPS);
+   ps2_p->set_scan_set(2);
+   sim_ps2()->set_nack(1);              // first byte of the next command
+   ps2_p->set_kb_leds(Ps2Core::LED_NUM);
+   n = 0;
+   t_max = 0;
+   t_done = 0;
+   while (now_us() - start < 60000) {
+      t = now_us();
+      while (ps2_p->get_key_event(&ev))
+         n++;
+      t = now_us() - t;
+      if (t > t_max)
+         t_max = t;
+      if (t_done == 0 && ps2_p->cmd_pending() == 0)
+         t_done = now_us() - start;
+      sleep_ms(1);
+   }
+   uart.disp("ps2 cmd events/done (us)/max poll (us)/last cmd: ");
+   uart.disp(n);
+   uart.disp(" / ");
+   uart.disp((int) t_done);
+   uart.disp(" / ");
+   uart.disp((int) t_max);
+   uart.disp(" / ");
+   uart.disp(sim_ps2()->last_cmd(), 16);
+   uart.disp("\n\r");
+   // device refusing every byte of the LED command
+   sim_ps2()->set_nack(Ps2Core::CMD_RETRIES + 1);
+   ps2_p->set_kb_leds(Ps2Core::LED_SCROLL);
+   ps2_p->send_cmd(0xf4);               // enable, must still be sent
+   start = now_us();
+   while (ps2_p->cmd_pending() && now_us() - start < 200000) {
+      ps2_p->poll_kb();
+      sleep_ms(1);
+   }
+   uart.disp("ps2 cmd failed/pending/last cmd: ");
+   uart.disp((int) ps2_p->cmd_failed());
+   uart.disp(" / ");
+   uart.disp(ps2_p->cmd_pending());
+   uart.disp(" / ");
+   uart.disp(sim_ps2()->last_cmd(), 16);
+   uart.disp("\n\r");
+}
+#endif  // _HOST_SIM
+
+GpoCore led(get_slot_addr(BRIDGE_BASE, S2_LED));
+GpiCore sw(get_slot_addr(BRIDGE_BASE, S3_SW));
+XadcCore adc(get_slot_addr(BRIDGE_BASE, S5_XDAC));
+PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+DebounceCore btn(get_slot_addr(BRIDGE_BASE, S7_BTN));
+SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
+SpiCore spi(get_slot_addr(BRIDGE_BASE, S9_SPI));
+I2cCore adt7420(get_slot_addr(BRIDGE_BASE, S10_I2C));
+Ps2Core ps2(get_slot_addr(BRIDGE_BASE, S11_PS2));
+DdfsCore ddfs(get_slot_addr(BRIDGE_BASE, S12_DDFS));
+AdsrCore adsr(get_slot_addr(BRIDGE_BASE, S13_ADSR), &ddfs);
+
+
+#ifdef _HOST_SIM
+/**
+ * run the terminating check routines once on the simulated bus
+ * and report the bus cost of each
+ */
+void sim_check() {
+   uint64_t t;
+
+   sim_timer()->set_count(0);
+   sim_clear_stats();
+   t = sim_clock();
+   uart_check();
+   sim_report("uart_check", t);
+   t = sim_clock();
+   timer_check(&led);
+   sim_report("timer_check", t);
+   t = sim_clock();
+   led_check(&led, 16);
+   sim_report("led_check", t);
+   t = sim_clock();
+   sseg_check(&sseg);
+   sim_report("sseg_check", t);
+   t = sim_clock();
+   sseg_mmio_check(&sseg);
+   sim_report("sseg_mmio_check", t);
+   t = sim_clock();
+   pwm_3color_led_check(&pwm);
+   sim_report("pwm_3color_led_check", t);
+   t = sim_clock();
+   gsensor_check(&spi, &led);
+   sim_report("gsensor_check", t);
+   t = sim_clock();
+   gpo_bench(&led);
+   sim_report("gpo_bench", t);
+   t = sim_clock();
+   edge_check(&sw, &btn);
+   sim_report("edge_check", t);
+   t = sim_clock();
+   led_seq_check(&led);
+   sim_report("led_seq_check", t);
+   t = sim_clock();
+   bcm_check(&led);
+   sim_report("bcm_check", t);
+   t = sim_clock();
+   pwm_dither_check(&pwm);
+   sim_report("pwm_dither_check", t);
+   t = sim_clock();
+   adt7420_check(&adt7420, &led, &sseg);
+   sim_report("adt7420_check", t);
+   // start just below a lower-word wrap; time cpu work with host clock
+   // (drain the uart first: its free-space estimate assumes a steady timer)
+   sleep_ms(300);
+   sim_timer()->set_count(0xffffff00ULL);
+   sim_set_host_clock(1);
+   t = sim_clock();
+   timer_bench();
+   sim_report("timer_bench", t);
+   t = sim_clock();
+   timer_wheel_bench();
+   sim_report("timer_wheel_bench", t);
+   t = sim_clock();
+   fmt_bench();
+   sim_report("fmt_bench", t);
+   t = sim_clock();
+   pwm_fade_bench(&pwm);
+   sim_report("pwm_fade_bench", t);
+   t = sim_clock();
+   pwm_color_bench(&pwm);
+   sim_report("pwm_color_bench", t);
+   t = sim_clock();
+   sseg_num_bench(&sseg);
+   sim_report("sseg_num_bench", t);
+   t = sim_clock();
+   db_trace_check();
+   sim_report("db_trace_check", t);
+   t = sim_clock();
+   log_check();
+   sim_report("log_check", t);
+   sim_set_host_clock(0);
+   t = sim_clock();
+   sched_check(&led, &sw, &btn);
+   sim_report("sched_check", t);
+   t = sim_clock();
+   uart_tx_check();
+   sim_report("uart_tx_check", t);
+   t = sim_clock();
+   uart_bulk_check();
+   sim_report("uart_bulk_check", t);
+   t = sim_clock();
+   blog_check(&adc);
+   sim_report("blog_check", t);
+   t = sim_clock();
+   kb_check(&ps2);
+   sim_report("kb_check", t);
+   t = sim_clock();
+   kb_chord_check(&ps2);
+   sim_report("kb_chord_check", t);
+   t = sim_clock();
+   mouse_check(&ps2);
+   sim_report("mouse_check", t);
+   t = sim_clock();
+   ps2_init_check(&ps2);
+   sim_report("ps2_init_check", t);
+   t = sim_clock();
+   ps2_cmd_check(&ps2);
+   sim_report("ps2_cmd_check", t);
+#ifdef __cpp_impl_coroutine
+   t = sim_clock();
+   async_check(&spi, &adt7420);
+   sim_report("async_check", t);
+#endif
+}
+#endif  // _HOST_SIM
 
 int main() {
 
+#ifdef _HOST_SIM
+   // off-board run: no keyboard/switches, so skip the game loop
+   sim_check();
+   return (0);
+#endif
    while (1) {
       
-      catchTheLight(&ps2, &led, &sseg, &sw);
+      catchTheLight(&ps2, &led, &sseg, &sw, &pwm);
 
    }
 
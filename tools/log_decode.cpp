@@ -0,0 +1,319 @@
+/*****************************************************************//**
+ * @file log_decode.cpp
+ *
+ * @brief Host decoder of BLOG() binary log records
+ *
+ * Description:
+ *  - scans the given source files for BLOG("...") format strings
+ *    and builds the message id table (same hash as the target);
+ *    BLOG examples inside comments are ignored
+ *  - reads the captured uart stream from stdin; text bytes are
+ *    copied through and each record is printed as formatted text
+ *    with its time stamp; 0xfe escapes inside a record are undone
+ *    and a 0xff within a record (lost bytes) starts a new record
+ *  - build: g++ -std=c++11 -I"../Vitis(c++)" log_decode.cpp -o log_decode
+ *  - usage: log_decode [-t] source_files... < uart_capture
+ *           -t: print the generated id table and exit
+ *
+ * @author agent
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "bin_log_id.h"
+
+struct LogEntry {
+   uint16_t id;
+   std::string fmt;
+   std::string where;   // file:line of the first call site
+};
+
+static std::vector<LogEntry> table;
+
+static LogEntry *find(uint16_t id) {
+   size_t i;
+
+   for (i = 0; i < table.size(); i++) {
+      if (table[i].id == id)
+         return (&table[i]);
+   }
+   return (0);
+}
+
+// parse a string literal starting after the opening quote
+static int parse_literal(const char *p, std::string &out) {
+   const char *start = p;
+
+   out.clear();
+   while (*p && *p != '"') {
+      if (*p == '\\' && p[1]) {
+         p++;
+         switch (*p) {
+         case 'n':
+            out += '\n';
+            break;
+         case 'r':
+            out += '\r';
+            break;
+         case 't':
+            out += '\t';
+            break;
+         case '0':
+            out += '\0';
+            break;
+         default:      // \\ \" \'
+            out += *p;
+         }
+      } else {
+         out += *p;
+      }
+      p++;
+   }
+   return (*p == '"') ? (int) (p - start) : -1;
+}
+
+// blank out // and /* */ comments; newlines are kept for line numbers
+static void strip_comments(std::string &text) {
+   size_t i;
+   char quote;
+
+   i = 0;
+   while (i < text.size()) {
+      if (text[i] == '"' || text[i] == '\'') {
+         quote = text[i++];
+         while (i < text.size() && text[i] != quote && text[i] != '\n') {
+            if (text[i] == '\\')
+               i++;
+            i++;
+         }
+         i++;
+      } else if (text.compare(i, 2, "//") == 0) {
+         while (i < text.size() && text[i] != '\n')
+            text[i++] = ' ';
+      } else if (text.compare(i, 2, "/*") == 0) {
+         while (i < text.size() && text.compare(i, 2, "*/") != 0) {
+            if (text[i] != '\n')
+               text[i] = ' ';
+            i++;
+         }
+         if (i < text.size()) {
+            text[i] = ' ';
+            text[i + 1] = ' ';
+            i = i + 2;
+         }
+      } else {
+         i++;
+      }
+   }
+}
+
+// add BLOG format strings of a source file; return -1 on id collision
+static int scan_file(const char *name) {
+   FILE *fp;
+   std::string text, fmt;
+   size_t pos;
+   const char *p;
+   char chunk[4096];
+   size_t n;
+   int line, err;
+   LogEntry e, *old;
+
+   fp = fopen(name, "rb");
+   if (!fp) {
+      fprintf(stderr, "log_decode: cannot open %s\n", name);
+      return (-1);
+   }
+   while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+      text.append(chunk, n);
+   fclose(fp);
+   strip_comments(text);
+   err = 0;
+   pos = 0;
+   while ((pos = text.find("BLOG(", pos)) != std::string::npos) {
+      pos = pos + 5;
+      p = text.c_str() + pos;
+      while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+         p++;
+      if (*p != '"')
+         continue;    // macro definition or non-literal use
+      if (parse_literal(p + 1, fmt) < 0)
+         continue;
+      line = 1;
+      for (size_t i = 0; i < pos; i++)
+         line += (text[i] == '\n');
+      e.id = bin_log_id(fmt.c_str());
+      e.fmt = fmt;
+      e.where = std::string(name) + ":" + std::to_string(line);
+      old = find(e.id);
+      if (old == 0) {
+         table.push_back(e);
+      } else if (old->fmt != fmt) {
+         fprintf(stderr, "log_decode: id 0x%04x collision: %s and %s\n",
+               e.id, old->where.c_str(), e.where.c_str());
+         err = -1;
+      }
+   }
+   return (err);
+}
+
+// next record byte with escapes undone; -1 at eof or at a record start
+static int get_byte() {
+   int c;
+
+   c = getchar();
+   if (c == 0xff) {
+      ungetc(c, stdin);   // record cut short; resync on this start byte
+      return (-1);
+   }
+   if (c == 0xfe) {
+      c = getchar();
+      if (c == EOF || c == 0xff) {
+         if (c == 0xff)
+            ungetc(c, stdin);
+         return (-1);
+      }
+      c = c + 0xfe;
+   }
+   return (c);
+}
+
+static int get_varint(uint32_t *v) {
+   int c, shift;
+
+   *v = 0;
+   for (shift = 0; shift < 35; shift += 7) {
+      c = get_byte();
+      if (c < 0)
+         return (-1);
+      *v = *v | ((uint32_t) (c & 0x7f) << shift);
+      if (!(c & 0x80))
+         return (0);
+   }
+   return (-1);
+}
+
+// print one record body following the format; return -1 if cut short
+static int print_record(const std::string &fmt) {
+   char spec[32];
+   size_t i, k;
+   uint32_t v;
+   int32_t sv;
+   int c, b;
+   union {
+      float f;
+      uint32_t u;
+   } bits;
+
+   for (i = 0; i < fmt.size(); i++) {
+      if (fmt[i] != '%') {
+         putchar(fmt[i]);
+         continue;
+      }
+      if (i + 1 < fmt.size() && fmt[i + 1] == '%') {
+         putchar('%');
+         i++;
+         continue;
+      }
+      // copy flags/width/precision up to the conversion char
+      k = 0;
+      while (i < fmt.size() && k < sizeof(spec) - 3
+            && !strchr("diuxXcfeEgG", fmt[i]))
+         spec[k++] = fmt[i++];
+      if (i >= fmt.size())
+         break;
+      spec[k++] = fmt[i];
+      spec[k] = '\0';
+      switch (fmt[i]) {
+      case 'f':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+         bits.u = 0;
+         for (b = 0; b < 4; b++) {
+            if ((c = get_byte()) < 0)
+               return (-1);
+            bits.u = bits.u | ((uint32_t) c << (8 * b));
+         }
+         printf(spec, (double) bits.f);
+         break;
+      default:
+         if (get_varint(&v) < 0)
+            return (-1);
+         sv = (int32_t) ((v >> 1) ^ (0 - (v & 1)));   // zigzag
+         if (fmt[i] == 'd' || fmt[i] == 'i' || fmt[i] == 'c')
+            printf(spec, (int) sv);
+         else
+            printf(spec, (unsigned) sv);
+      }
+   }
+   return (0);
+}
+
+static void decode() {
+   int c, lo, hi;
+   uint32_t delta;
+   uint64_t t_us = 0;
+   LogEntry *e;
+
+   while ((c = getchar()) != EOF) {
+      if (c != 0xff) {
+         putchar(c);    // plain uart text
+         continue;
+      }
+      lo = get_byte();
+      hi = get_byte();
+      if (lo < 0 || hi < 0 || get_varint(&delta) < 0) {
+         if (feof(stdin))
+            break;
+         printf("<truncated record>\n");
+         continue;
+      }
+      t_us = t_us + delta;
+      printf("[%10.6f] ", (double) t_us / 1e6);
+      e = find((uint16_t) (lo | (hi << 8)));
+      if (e == 0) {
+         // arguments cannot be skipped; following bytes pass as text
+         printf("<unknown id 0x%04x>\n", lo | (hi << 8));
+         continue;
+      }
+      if (print_record(e->fmt) < 0) {
+         if (feof(stdin))
+            break;
+         printf("<truncated record>\n");
+      }
+   }
+}
+
+int main(int argc, char **argv) {
+   int i, list, err;
+
+   list = 0;
+   err = 0;
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-t") == 0)
+         list = 1;
+      else if (scan_file(argv[i]) < 0)
+         err = 1;
+   }
+   if (list) {
+      for (i = 0; i < (int) table.size(); i++) {
+         printf("0x%04x  %-28s  \"", table[i].id, table[i].where.c_str());
+         for (char ch : table[i].fmt) {
+            if (ch == '\n')
+               printf("\\n");
+            else if (ch == '\r')
+               printf("\\r");
+            else
+               putchar(ch);
+         }
+         printf("\"\n");
+      }
+      return (err);
+   }
+   decode();
+   return (err);
+}